@@ -4,19 +4,41 @@ const int POINT = 0;
 const int DIR = 1;
 const int SPOT = 2;
 
-struct Light {
-    int type;
+// must match LightGrid
+const int TILES_X = 16;
+const int TILES_Y = 9;
+const int SLICES = 24;
 
+// member order matches the four texels of each light in lightData
+struct Light {
     vec4 color;
     vec3 function;
+    int type;
 
     vec3 pos;
-    vec3 dir;
-
     float penumbra;
+    vec3 dir;
     float angle;
 };
-uniform Light lights[8];
+
+// every light, directional first, then (offset, count) per cluster into lists of light indexes
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightCells;
+uniform usamplerBuffer lightIndexes;
+
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    vec4 clusterParams; // near, far, slice scale
+};
+
+layout(std140) uniform Globals {
+    float ka;
+    float kd;
+    float ks;
+    int numDirLights;
+};
 
 struct Material {
     vec4 ambient;
@@ -24,26 +46,61 @@ struct Material {
     vec4 specular;
     float shininess;
     float blend;
+    float repeatU;
+    float repeatV;
 };
-uniform Material material;
+layout(std140) uniform Materials {
+    Material materials[256];
+};
+
+// material of current instance, fetched once in main
+Material material;
+
+// surface of current fragment, shared by every light and computed once in main
+vec3 norm;
+vec4 diffuse;
+vec3 toCam;
 
 in vec3 worldPos;
 in vec3 worldNorm;
 in vec2 UV;
+#ifdef NORMAL_MAP
 in vec3 worldTang;
 in vec3 worldBitang;
+#endif
+flat in int matIdx;
+flat in ivec2 layers; // diffuse and normal texture array layers
 
 out vec4 fragColor;
 
-uniform float ka;
-uniform float kd;
-uniform float ks;
-uniform vec3 camPos;
+uniform sampler2DArray tex;
+#ifdef NORMAL_MAP
+uniform sampler2DArray normTex;
+#endif
+
+Light fetchLight(int i) {
+    vec4 t0 = texelFetch(lightData, i * 4);
+    vec4 t1 = texelFetch(lightData, i * 4 + 1);
+    vec4 t2 = texelFetch(lightData, i * 4 + 2);
+    vec4 t3 = texelFetch(lightData, i * 4 + 3);
+
+    // type is stored as a whole float, round rather than truncate
+    return Light(t0, t1.xyz, int(floor(t1.w + 0.5)), t2.xyz, t2.w, t3.xyz, t3.w);
+}
+
+// cluster containing this fragment, same tiles and exponential slices the grid was binned with
+int getCluster() {
+    vec4 viewPos = view * vec4(worldPos, 1.0);
+    vec4 clipPos = proj * viewPos;
+
+    ivec2 tile = ivec2((clipPos.xy / clipPos.w * 0.5 + 0.5) * vec2(TILES_X, TILES_Y));
+    tile = clamp(tile, ivec2(0), ivec2(TILES_X - 1, TILES_Y - 1));
 
-uniform sampler2D tex;
-uniform sampler2D normTex;
+    int slice = int(log(max(-viewPos.z, clusterParams.x) / clusterParams.x) * clusterParams.z);
+    slice = clamp(slice, 0, SLICES - 1);
 
-uniform bool hasNormMap;
+    return (slice * TILES_Y + tile.y) * TILES_X + tile.x;
+}
 
 float attenuate(vec3 c, float d) {
     return min(1.0, 1.0 / (c.x + d*c.y + d*d*c.z));
@@ -57,37 +114,33 @@ vec4 lerper(vec4 a, vec4 b, float t) {
     return a + t * (b - a);
 }
 
+#ifdef NORMAL_MAP
 vec3 updateNorm(vec3 norm) {
     // compute TBN to convert from tangent space (normalize tangents + bitangents!!!)
     mat3 TBN = mat3(normalize(worldTang), normalize(worldBitang), norm);
 
-    // sample normal map, scale [0, 1] -> [-1, 1], convert tangent -> world space
-    return normalize(TBN * (texture(normTex, UV).rgb * 2.0 - 1.0));
+    // sample two channel normal map, scale [0, 1] -> [-1, 1], rebuild z from unit length
+    vec2 xy = texture(normTex, vec3(UV, layers.y)).rg * 2.0 - 1.0;
+    vec3 tangNorm = vec3(xy, sqrt(max(0.0, 1.0 - dot(xy, xy))));
+
+    // convert tangent -> world space
+    return normalize(TBN * tangNorm);
 }
+#endif
 
 vec4 point(Light light) {
     vec4 illum = vec4(0.0);
 
-    // normalize normal
-    vec3 norm = normalize(worldNorm);
-
-    // update normal
-    if (hasNormMap) norm = updateNorm(norm);
-
     // compute attenuation
     float f_att = attenuate(light.function, distance(light.pos, worldPos));
 
     // dot product of surface normal and surface-to-light direction
     float N_L = dot(norm, normalize(light.pos - worldPos));
-    vec4 diffuse = kd * material.diffuse;
-
-    // blend diffuse color with texture color
-    diffuse = lerper(diffuse, texture(tex, UV), material.blend);
 
     illum += f_att * diffuse * light.color * clamp(N_L, 0, 1);
 
     // dot product of reflected light and surface-to-camera direction
-    float R_E = clamp(dot(normalize(reflect(worldPos - light.pos, norm)), normalize(camPos - worldPos)), 0, 1);
+    float R_E = clamp(dot(normalize(reflect(worldPos - light.pos, norm)), toCam), 0, 1);
     float specular = pow(R_E, material.shininess);
 
     // if pow is undefined, reset specular term
@@ -103,23 +156,13 @@ vec4 point(Light light) {
 vec4 dir(Light light) {
     vec4 illum = vec4(0.0);
 
-    // normalize normal
-    vec3 norm = normalize(worldNorm);
-
-    // update normal
-    if (hasNormMap) norm = updateNorm(norm);
-    
     // dot product of surface normal and surface-to-light direction
     float N_L = dot(norm, normalize(-light.dir));
-    vec4 diffuse = kd * material.diffuse;
-
-    // blend diffuse color with texture color
-    diffuse = lerper(diffuse, texture(tex, UV), material.blend);
 
     illum += diffuse * light.color * clamp(N_L, 0, 1);
 
     // dot product of reflected light and surface-to-camera direction
-    float R_E = clamp(dot(normalize(reflect(light.dir, norm)), normalize(camPos - worldPos)), 0, 1);
+    float R_E = clamp(dot(normalize(reflect(light.dir, norm)), toCam), 0, 1);
     float specular = pow(R_E, material.shininess);
 
     // if pow is undefined, reset specular term
@@ -154,19 +197,47 @@ vec4 spot(Light light) {
 }
 
 void main() {
+    material = materials[matIdx];
+
     fragColor = ka * material.ambient;
 
-    for (int i = 0; i < 8; ++i) {
-        Light light = lights[i];
+    // normalize normal, then perturb it by the normal map once for every light
+    norm = normalize(worldNorm);
+#ifdef NORMAL_MAP
+    norm = updateNorm(norm);
+#endif
+
+    // blend diffuse color with texture color
+    diffuse = lerper(kd * material.diffuse, texture(tex, vec3(UV, layers.x)), material.blend);
+
+    toCam = normalize(camPos - worldPos);
+
+#ifdef DIR_LIGHTS
+    // directional lights reach everything
+    for (int i = 0; i < numDirLights; ++i) fragColor += dir(fetchLight(i));
+#endif
+
+#if defined(POINT_LIGHTS) || defined(SPOT_LIGHTS)
+    // point and spot lights only from this fragment's cluster
+    uvec2 cell = texelFetch(lightCells, getCluster()).xy;
+
+    for (uint i = 0u; i < cell.y; ++i) {
+        Light light = fetchLight(int(texelFetch(lightIndexes, int(cell.x + i)).x));
 
+#if defined(POINT_LIGHTS) && defined(SPOT_LIGHTS)
+        // scene mixes both, type is only known per light
         if (light.type == POINT) {
             fragColor += point(light);
-        } else if (light.type == DIR) {
-            fragColor += dir(light);
         } else if (light.type == SPOT) {
             fragColor += spot(light);
         }
+#elif defined(POINT_LIGHTS)
+        fragColor += point(light);
+#else
+        fragColor += spot(light);
+#endif
     }
+#endif
 
     fragColor = clamp(fragColor, 0.0, 1.0);
     // fragColor = vec4(abs(normalize(worldNorm)), 1.0);
@@ -1,104 +1,162 @@
 #version 330 core
 
+// packed vertex attribs, normalized by the vertex fetch
 layout(location = 0) in vec3 objPos;
 layout(location = 1) in vec3 objNorm;
 layout(location = 2) in vec2 objUV;
-layout(location = 3) in vec3 objTang;
-layout(location = 4) in vec3 objBitang;
-layout(location = 5) in ivec4 boneIDs;
+layout(location = 3) in vec4 objTang; // w = bitangent sign
+layout(location = 5) in uvec4 boneIDs;
 layout(location = 6) in vec4 weights;
 
-const int MAX_BONES = 128;
+// per-instance attribs
+layout(location = 7) in mat4 model;
+layout(location = 11) in mat3 modelInvT;
+layout(location = 14) in int materialIdx;
+layout(location = 15) in ivec2 texLayers;
+
 const int MAX_WEIGHTS = 4;
 
+// texels per bone in palette (4 skin mat cols + 3 normal mat cols)
+const int PALETTE_STRIDE = 7;
+
 out vec3 worldPos;
 out vec3 worldNorm;
 out vec2 UV;
+#ifdef NORMAL_MAP
 out vec3 worldTang;
 out vec3 worldBitang;
+#endif
+flat out int matIdx;
+flat out ivec2 layers;
+
+struct Material {
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    float shininess;
+    float blend;
+    float repeatU;
+    float repeatV;
+};
+layout(std140) uniform Materials {
+    Material materials[256];
+};
+
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 proj;
+    vec3 camPos;
+    vec4 clusterParams; // near, far, slice scale
+};
+
+#ifdef SKINNED
+uniform samplerBuffer skinPalette;
+
+mat4 fetchSkinMat(int bone) {
+    int base = bone * PALETTE_STRIDE;
+
+    return mat4(texelFetch(skinPalette, base),
+                texelFetch(skinPalette, base + 1),
+                texelFetch(skinPalette, base + 2),
+                texelFetch(skinPalette, base + 3));
+}
 
-uniform mat4 model;
-uniform mat3 modelInvT;
-
-uniform mat4 view;
-uniform mat4 proj;
-
-uniform float repeatU;
-uniform float repeatV;
+mat3 fetchNormMat(int bone) {
+    int base = bone * PALETTE_STRIDE + 4;
 
-uniform mat4 skinMats[MAX_BONES];
-uniform mat3 skinMatsT[MAX_BONES];
+    return mat3(texelFetch(skinPalette, base).xyz,
+                texelFetch(skinPalette, base + 1).xyz,
+                texelFetch(skinPalette, base + 2).xyz);
+}
+#endif
 
-uniform bool hasBones;
+// object space surface, skinned in place when SKINNED
+vec4 pos;
+vec3 norm;
+#ifdef NORMAL_MAP
+vec3 tang;
+vec3 bitang; // rebuilt from normal, tangent and handedness
+#endif
 
+#ifdef SKINNED
 void processBones() {
+    int numBones = textureSize(skinPalette) / PALETTE_STRIDE;
+
     vec4 initPos = vec4(0.0);
     vec3 initNorm = vec3(0.0);
+#ifdef NORMAL_MAP
     vec3 initTang = vec3(0.0);
     vec3 initBitang = vec3(0.0);
+#endif
     float weightSum = 0.0;
 
     // For each bone ID + weight
     for (int i = 0; i < MAX_WEIGHTS; ++i) {
-        // Skip invalid bones + weights
-        if (boneIDs[i] < 0 || weights[i] <= 0.0) continue;
-
-        // If bone is in bone matrix array range
-        if (boneIDs[i] < MAX_BONES) {
-            // Add weighted skinning transform to total position
-            initPos += skinMats[boneIDs[i]] * vec4(objPos, 1.0) * weights[i];
-            // Add weighted skinning transpose to total normal
-            initNorm += skinMatsT[boneIDs[i]] * objNorm * weights[i];
-            // Add weighted skinning transpose to total tangent
-            initTang += skinMatsT[boneIDs[i]] * objTang * weights[i];
-            // Add weighted skinning transpose to total bitangent
-            initBitang += skinMatsT[boneIDs[i]] * objBitang * weights[i];
-            // Add up weights
-            weightSum += weights[i];
-        } else {
-            // Reset vals if out of range
-            initPos = vec4(objPos, 1.0);
-            initNorm = objNorm;
-            initTang = objTang;
-            initBitang = objBitang;
-            weightSum = 1.0;
-            break;
-        }
+        // Skip unused weights
+        if (weights[i] <= 0.0) continue;
+
+        int bone = int(boneIDs[i]);
+
+        // Keep bind pose if bone is out of palette range
+        if (bone >= numBones) return;
+
+        mat4 skinMat = fetchSkinMat(bone);
+        mat3 normMat = fetchNormMat(bone);
+
+        // Add weighted skinning transform to total position
+        initPos += skinMat * pos * weights[i];
+        // Add weighted skinning transpose to total normal
+        initNorm += normMat * norm * weights[i];
+#ifdef NORMAL_MAP
+        // Add weighted skinning transpose to total tangent
+        initTang += normMat * tang * weights[i];
+        // Add weighted skinning transpose to total bitangent
+        initBitang += normMat * bitang * weights[i];
+#endif
+        // Add up weights
+        weightSum += weights[i];
     }
 
     // Normalize results
     if (weightSum > 0.0) {
-        initPos /= weightSum;
-        initNorm /= weightSum;
-        initTang /= weightSum;
-        initBitang /= weightSum;
+        pos = initPos / weightSum;
+        norm = initNorm / weightSum;
+#ifdef NORMAL_MAP
+        tang = initTang / weightSum;
+        bitang = initBitang / weightSum;
+#endif
     }
+}
+#endif
 
-    worldPos = vec3(model * initPos);
+void main() {
+    pos = vec4(objPos, 1.0);
+    norm = objNorm;
+#ifdef NORMAL_MAP
+    tang = objTang.xyz;
+    bitang = cross(objNorm, objTang.xyz) * objTang.w;
+#endif
 
-    worldNorm = normalize(modelInvT * initNorm);
+#ifdef SKINNED
+    processBones();
+#endif
 
-    // normal map math
-    worldTang = normalize(modelInvT * initTang);
+    worldPos = vec3(model * pos);
 
-    worldBitang = normalize(modelInvT * initBitang);
-}
+    worldNorm = normalize(modelInvT * norm);
 
-void main() {
-    if (hasBones) processBones();
-    else {
-        worldPos = vec3(model * vec4(objPos, 1.0));
-
-        worldNorm = normalize(modelInvT * objNorm);
+#ifdef NORMAL_MAP
+    // normal map math
+    worldTang = normalize(modelInvT * tang);
 
-        // normal map math
-        worldTang = normalize(modelInvT * objTang);
+    worldBitang = normalize(modelInvT * bitang);
+#endif
 
-        worldBitang = normalize(modelInvT * objBitang);
-    } 
+    matIdx = materialIdx;
+    layers = texLayers;
 
-    UV.x = objUV.x * repeatU;
-    UV.y = objUV.y * repeatV;
+    UV.x = objUV.x * materials[materialIdx].repeatU;
+    UV.y = objUV.y * materials[materialIdx].repeatV;
 
     gl_Position = proj * view * vec4(worldPos, 1.0);
 }
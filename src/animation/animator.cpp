@@ -3,6 +3,7 @@
 #include <glm/gtx/quaternion.hpp>
 #include <stdexcept>
 #include <algorithm>
+#include "utils/profiler.h"
 
 Animator::Animator(const AnimData& animData) :
     m_anims(animData.animations),
@@ -10,12 +11,27 @@ Animator::Animator(const AnimData& animData) :
     m_boneMap(animData.boneToIdx),
     m_anim(m_anims.empty() ? nullptr : std::make_unique<Animation>(m_anims.front())),
     m_animIter(m_anims.begin())
-{}
+{
+    // Init palette with bind pose
+    computePalette();
+}
 
 const std::vector<glm::mat4>& Animator::getSkinMats() const {
     return m_skinMats;
 }
 
+const std::vector<glm::vec4>& Animator::getPalette() const {
+    return m_palette;
+}
+
+bool Animator::isDirty() const {
+    return m_dirty;
+}
+
+void Animator::clearDirty() {
+    m_dirty = false;
+}
+
 void Animator::play() {
     m_isPlaying = !m_isPlaying;
 }
@@ -28,6 +44,8 @@ void Animator::update(float deltaTime) {
     // Do not update if no animation or not playing
     if (!m_anim || !m_isPlaying) return;
 
+    PROFILE_ZONE("Animator::update");
+
     // Update number of ticks
     m_ticks += deltaTime * m_anim->ticksPerSec;
 
@@ -87,6 +105,25 @@ void Animator::computeSkinMats(float now) {
         // Apply offset (inverse bind pose) matrix to bone CTM
         m_skinMats[i] *= m_skeleton[i].offset;
     }
+
+    // Pack skinning matrices into palette
+    computePalette();
+}
+
+void Animator::computePalette() {
+    m_palette.resize(m_skinMats.size() * PALETTE_STRIDE);
+
+    for (int i = 0; i < m_skinMats.size(); ++i) {
+        // Compute normal matrix once per bone instead of once per draw
+        glm::mat3 normMat = glm::transpose(glm::inverse(glm::mat3{m_skinMats[i]}));
+
+        glm::vec4* texels = &m_palette[i * PALETTE_STRIDE];
+
+        for (int col = 0; col < 4; ++col) texels[col] = m_skinMats[i][col];
+        for (int col = 0; col < 3; ++col) texels[4 + col] = glm::vec4{normMat[col], 0.f};
+    }
+
+    m_dirty = true;
 }
 
 void Animator::processBone(const std::string& name, glm::mat4 ctm) {
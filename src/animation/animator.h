@@ -7,10 +7,20 @@
 class Animator
 {
 public:
+    // texels per bone in palette (4 skin mat cols + 3 normal mat cols)
+    static constexpr int PALETTE_STRIDE = 7;
+
     Animator(const AnimData& animData);
 
     const std::vector<glm::mat4>& getSkinMats() const;
 
+    const std::vector<glm::vec4>& getPalette() const;
+
+    // dirty flag for uploading palette only when it changes
+    bool isDirty() const;
+
+    void clearDirty();
+
     const bool hasAnim() const;
 
     void update(float deltaTime);
@@ -28,9 +38,12 @@ private:
 
     float m_ticks = 0.f;
     std::vector<glm::mat4> m_skinMats{m_skeleton.size(), glm::mat4{1.f}};
+    std::vector<glm::vec4> m_palette;
     bool m_isPlaying = true;
+    bool m_dirty = true;
 
     void computeSkinMats(float now);
+    void computePalette();
     void computeBoneMats(float now);
 
     void processBone(const std::string& name, glm::mat4 mat);
@@ -0,0 +1,35 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <GL/glew.h>
+
+// Offscreen color and depth target, kept alive across frames instead of rebuilt per capture
+class Framebuffer
+{
+public:
+    Framebuffer() {}
+
+    Framebuffer(int width, int height);
+
+    void bind() const;
+
+    void unbind() const;
+
+    GLuint getId() const;
+
+    int getWidth() const;
+
+    int getHeight() const;
+
+    void clean();
+
+private:
+    GLuint m_fbo = 0;
+    GLuint m_color = 0; // RGBA8 renderbuffer
+    GLuint m_depth = 0; // 24 bit depth renderbuffer
+
+    int m_width = 0;
+    int m_height = 0;
+};
+
+#endif // FRAMEBUFFER_H
@@ -0,0 +1,75 @@
+#include "instancebuffer.h"
+#include <cstddef>
+#include <algorithm>
+#include "utils/gpuprofiler.h"
+
+InstanceBuffer::InstanceBuffer(size_t capacity) :
+    m_size(capacity * sizeof(InstanceData))
+{
+    glGenBuffers(1, &m_vbo);
+
+    // preallocate storage for expected number of instances
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, m_size, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::update(const std::vector<InstanceData>& instances) {
+    PROFILE_ZONE("InstanceBuffer::update");
+    GPU_ZONE("InstanceBuffer::update");
+
+    GLsizeiptr size = instances.size() * sizeof(InstanceData);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+    // grow if needed
+    m_size = std::max(m_size, size);
+
+    // orphan last frame's storage so the driver does not stall on it
+    glBufferData(GL_ARRAY_BUFFER, m_size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data());
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::bindAttribs(int first) const {
+    // GL 4.1 has no base instance, so offset the attrib pointers instead
+    size_t base = first * sizeof(InstanceData);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+
+    // model matrix attrib = 7-10 (one column per location)
+    for (int col = 0; col < 4; ++col) {
+        glEnableVertexAttribArray(7 + col);
+        glVertexAttribPointer(7 + col, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              reinterpret_cast<void*>(base + offsetof(InstanceData, model) + col * sizeof(glm::vec4)));
+        glVertexAttribDivisor(7 + col, 1);
+    }
+
+    // normal matrix attrib = 11-13 (one column per location)
+    for (int col = 0; col < 3; ++col) {
+        glEnableVertexAttribArray(11 + col);
+        glVertexAttribPointer(11 + col, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              reinterpret_cast<void*>(base + offsetof(InstanceData, normMat) + col * sizeof(glm::vec3)));
+        glVertexAttribDivisor(11 + col, 1);
+    }
+
+    // material index attrib = 14
+    // NOTE: using glVertexAttrib*I*Pointer, not glVertexAttribPointer
+    glEnableVertexAttribArray(14);
+    glVertexAttribIPointer(14, 1, GL_INT, sizeof(InstanceData),
+                           reinterpret_cast<void*>(base + offsetof(InstanceData, material)));
+    glVertexAttribDivisor(14, 1);
+
+    // texture layer attrib = 15
+    glEnableVertexAttribArray(15);
+    glVertexAttribIPointer(15, 2, GL_INT, sizeof(InstanceData),
+                           reinterpret_cast<void*>(base + offsetof(InstanceData, layers)));
+    glVertexAttribDivisor(15, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::clean() {
+    glDeleteBuffers(1, &m_vbo);
+}
@@ -0,0 +1,35 @@
+#ifndef INSTANCEBUFFER_H
+#define INSTANCEBUFFER_H
+
+#include <GL/glew.h>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Per-instance vertex data, read at attrib locations 7-15
+struct InstanceData {
+    glm::mat4 model;   // locations 7-10
+    glm::mat3 normMat; // locations 11-13
+    int material;      // location 14
+    glm::ivec2 layers; // location 15, diffuse and normal texture array layers
+};
+
+class InstanceBuffer
+{
+public:
+    InstanceBuffer() {}
+
+    InstanceBuffer(size_t capacity);
+
+    void update(const std::vector<InstanceData>& instances);
+
+    // point instance attribs of the bound VAO at the given instance
+    void bindAttribs(int first) const;
+
+    void clean();
+
+private:
+    GLuint m_vbo = 0;      // instance buffer obj
+    GLsizeiptr m_size = 0; // allocated bytes
+};
+
+#endif // INSTANCEBUFFER_H
@@ -0,0 +1,33 @@
+#include "pixelbuffer.h"
+#include <cstring>
+
+PixelBuffer::PixelBuffer(int count) :
+    m_pbos(count)
+{
+    glGenBuffers(count, m_pbos.data());
+}
+
+void PixelBuffer::stage(const void* data, GLsizeiptr size) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbos[m_next]);
+    m_next = (m_next + 1) % m_pbos.size();
+
+    // orphan so a transfer still reading the old storage never stalls the copy
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+    if (mapped) {
+        std::memcpy(mapped, data, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    } else {
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
+    }
+}
+
+void PixelBuffer::unbind() const {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void PixelBuffer::clean() {
+    glDeleteBuffers(m_pbos.size(), m_pbos.data());
+}
@@ -0,0 +1,27 @@
+#ifndef PIXELBUFFER_H
+#define PIXELBUFFER_H
+
+#include <GL/glew.h>
+#include <vector>
+
+class PixelBuffer
+{
+public:
+    PixelBuffer() {}
+
+    PixelBuffer(int count);
+
+    // copy data into the next buffer of the ring and leave it bound as the unpack source
+    // texture uploads then read from offset 0 and return without waiting on the copy
+    void stage(const void* data, GLsizeiptr size);
+
+    void unbind() const;
+
+    void clean();
+
+private:
+    std::vector<GLuint> m_pbos; // ring of pixel unpack buffer objs
+    size_t m_next = 0;          // next buffer to stage into
+};
+
+#endif // PIXELBUFFER_H
@@ -0,0 +1,95 @@
+#include "readbackbuffer.h"
+#include "utils/stats.h"
+
+namespace
+{
+    // client waits are capped, so long waits loop in slices of this
+    constexpr GLuint64 MAX_WAIT_NS = 100'000'000;
+}
+
+ReadbackBuffer::ReadbackBuffer(int count, Consumer consume) :
+    m_slots(count),
+    m_consume(std::move(consume))
+{
+    for (Slot& slot : m_slots) glGenBuffers(1, &slot.pbo);
+}
+
+void ReadbackBuffer::read(GLuint fbo, int width, int height) {
+    // Hand off whatever already finished so the ring rarely fills
+    collect(false);
+
+    // Ring is full only if the GPU is several frames behind, the one case worth waiting in
+    if (m_pending == m_slots.size()) {
+        stats.captureStalls++;
+        collectOldest(true);
+    }
+
+    Slot& slot = m_slots[m_next];
+    m_next = (m_next + 1) % m_slots.size();
+    m_pending++;
+
+    GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    if (slot.size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.size = size;
+    }
+
+    // With a pack buffer bound the read only records a copy and returns at once
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void ReadbackBuffer::collect(bool wait) {
+    while (m_pending > 0 && collectOldest(wait));
+}
+
+bool ReadbackBuffer::collectOldest(bool wait) {
+    Slot& slot = m_slots[m_oldest];
+
+    // Polling flushes too, or a fence that was never submitted would never signal
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+    while (wait && status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(slot.fence, 0, MAX_WAIT_NS);
+    }
+
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size, GL_MAP_READ_BIT);
+
+    if (mapped) {
+        m_consume(static_cast<const unsigned char*>(mapped), slot.width, slot.height);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_oldest = (m_oldest + 1) % m_slots.size();
+    m_pending--;
+
+    return true;
+}
+
+void ReadbackBuffer::clean() {
+    // Drop copies still in flight, nothing is mapped between calls
+    for (Slot& slot : m_slots) {
+        if (slot.fence) glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.pbo);
+        slot = Slot{};
+    }
+
+    m_next = m_oldest = m_pending = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef READBACKBUFFER_H
+#define READBACKBUFFER_H
+
+#include <GL/glew.h>
+#include <functional>
+#include <vector>
+
+// Ring of pixel pack buffers that copy framebuffers back to the CPU a few frames late
+// each copy is fenced and only mapped once the GPU is done, so reads never stall the pipeline
+class ReadbackBuffer
+{
+public:
+    // receives bottom-up RGBA rows, only valid for the duration of the call
+    using Consumer = std::function<void(const unsigned char* pixels, int width, int height)>;
+
+    ReadbackBuffer() {}
+
+    ReadbackBuffer(int count, Consumer consume);
+
+    // queue a copy of the color attachment of fbo into the next buffer of the ring
+    // waits only if that buffer still holds a copy the GPU has not finished
+    void read(GLuint fbo, int width, int height);
+
+    // hand finished copies to the consumer oldest first, waiting for all of them if wait is set
+    void collect(bool wait);
+
+    void clean();
+
+private:
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr; // set while a copy is in flight
+        GLsizeiptr size = 0;    // allocated storage
+        int width = 0;
+        int height = 0;
+    };
+
+    std::vector<Slot> m_slots;
+    Consumer m_consume;
+    size_t m_next = 0;    // next slot to copy into
+    size_t m_oldest = 0;  // oldest slot in flight
+    size_t m_pending = 0; // slots in flight
+
+    // true if the oldest copy was handed to the consumer
+    bool collectOldest(bool wait);
+};
+
+#endif // READBACKBUFFER_H
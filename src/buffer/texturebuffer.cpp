@@ -0,0 +1,46 @@
+#include "texturebuffer.h"
+
+TextureBuffer::TextureBuffer(GLenum format) :
+    m_format(format)
+{
+    glGenBuffers(1, &m_tbo);
+    glGenTextures(1, &m_texId);
+
+    // a name only becomes a buffer object once bound, core profile rejects attaching it before
+    glBindBuffer(GL_TEXTURE_BUFFER, m_tbo);
+    glBufferData(GL_TEXTURE_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    // attach buffer storage to texture
+    glBindTexture(GL_TEXTURE_BUFFER, m_texId);
+    glTexBuffer(GL_TEXTURE_BUFFER, m_format, m_tbo);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::update(const void* data, GLsizeiptr size) {
+    glBindBuffer(GL_TEXTURE_BUFFER, m_tbo);
+
+    // reallocate on growth, otherwise overwrite in place
+    if (size > m_size) {
+        glBufferData(GL_TEXTURE_BUFFER, size, data, GL_DYNAMIC_DRAW);
+        m_size = size;
+    } else {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::bind(unsigned int slot) const {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_BUFFER, m_texId);
+}
+
+const GLuint TextureBuffer::getId() const {
+    return m_texId;
+}
+
+void TextureBuffer::clean() {
+    glDeleteTextures(1, &m_texId);
+    glDeleteBuffers(1, &m_tbo);
+}
@@ -0,0 +1,28 @@
+#ifndef TEXTUREBUFFER_H
+#define TEXTUREBUFFER_H
+
+#include <GL/glew.h>
+
+class TextureBuffer
+{
+public:
+    TextureBuffer() {}
+
+    TextureBuffer(GLenum format);
+
+    void update(const void* data, GLsizeiptr size);
+
+    void bind(unsigned int slot) const;
+
+    const GLuint getId() const;
+
+    void clean();
+
+private:
+    GLuint m_tbo = 0;      // texture buffer obj
+    GLuint m_texId = 0;    // buffer texture bound to tbo
+    GLenum m_format = GL_RGBA32F;
+    GLsizeiptr m_size = 0; // allocated bytes
+};
+
+#endif // TEXTUREBUFFER_H
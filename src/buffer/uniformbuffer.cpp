@@ -0,0 +1,29 @@
+#include "uniformbuffer.h"
+
+UniformBuffer::UniformBuffer(GLuint binding, GLsizeiptr size) :
+    m_binding(binding)
+{
+    glGenBuffers(1, &m_ubo);
+
+    // allocate storage, contents are filled in by update
+    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // attach buffer to its block binding point
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_binding, m_ubo);
+}
+
+void UniformBuffer::update(const void* data, GLsizeiptr size, GLintptr offset) const {
+    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+GLuint UniformBuffer::getBinding() const {
+    return m_binding;
+}
+
+void UniformBuffer::clean() {
+    glDeleteBuffers(1, &m_ubo);
+}
@@ -0,0 +1,24 @@
+#ifndef UNIFORMBUFFER_H
+#define UNIFORMBUFFER_H
+
+#include <GL/glew.h>
+
+class UniformBuffer
+{
+public:
+    UniformBuffer() {}
+
+    UniformBuffer(GLuint binding, GLsizeiptr size);
+
+    void update(const void* data, GLsizeiptr size, GLintptr offset = 0) const;
+
+    GLuint getBinding() const;
+
+    void clean();
+
+private:
+    GLuint m_ubo = 0;     // uniform buffer obj
+    GLuint m_binding = 0; // uniform block binding point
+};
+
+#endif // UNIFORMBUFFER_H
@@ -34,7 +34,13 @@ void Camera::setView(const glm::vec3& pos,
         glm::vec4(0.f, 0.f, 0.f, 1.f)
     };
 
-    m_view = rotation * Transform::translate(-pos);
+    glm::mat4 view = rotation * Transform::translate(-pos);
+
+    // only mark dirty if view actually changed
+    if (view != m_view) {
+        m_view = view;
+        m_dirty = true;
+    }
 }
 
 void Camera::setAspectRatio(float aspectRatio) {
@@ -59,6 +65,22 @@ const glm::vec3& Camera::getLook() const {
     return m_look;
 }
 
+float Camera::getNear() const {
+    return m_near;
+}
+
+float Camera::getFar() const {
+    return m_far;
+}
+
+float Camera::getHeightAngle() const {
+    return m_heightAngle;
+}
+
+float Camera::getWidthAngle() const {
+    return m_widthAngle;
+}
+
 void Camera::perspective(float near, float far) {
     m_near = near, m_far = far;
 
@@ -86,4 +108,14 @@ void Camera::perspective(float near, float far) {
     };
 
     m_proj = remappingMat * unhingingMat * scalingMat;
+
+    m_dirty = true;
+}
+
+bool Camera::isDirty() const {
+    return m_dirty;
+}
+
+void Camera::clearDirty() {
+    m_dirty = false;
 }
@@ -28,11 +28,24 @@ public:
 
     const glm::vec3& getLook() const;
 
-    void perspective(float near, float far);    
+    float getNear() const;
+
+    float getFar() const;
+
+    float getHeightAngle() const;
+
+    float getWidthAngle() const;
+
+    void perspective(float near, float far);
+
+    // dirty flag for uploading camera data only when it changes
+    bool isDirty() const;
+
+    void clearDirty();
 
 private:
-    glm::mat4 m_view;
-    glm::mat4 m_proj;
+    glm::mat4 m_view{1.f};
+    glm::mat4 m_proj{1.f};
 
     float m_aspectRatio;
     float m_heightAngle;
@@ -43,6 +56,8 @@ private:
 
     glm::vec3 m_pos;
     glm::vec3 m_look;
+
+    bool m_dirty = true;
 };
 
 #endif // CAMERA_H
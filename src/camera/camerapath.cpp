@@ -0,0 +1,79 @@
+#include "camerapath.h"
+#include <algorithm>
+#include <stdexcept>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace
+{
+    glm::vec3 toVec3(const QJsonValue& value, const char* field) {
+        QJsonArray array = value.toArray();
+
+        if (array.size() != 3 || !array[0].isDouble() || !array[1].isDouble() || !array[2].isDouble()) {
+            throw std::runtime_error(std::string("Camera path keyframe ") + field + " must be an array of 3 numbers");
+        }
+
+        return glm::vec3{array[0].toDouble(), array[1].toDouble(), array[2].toDouble()};
+    }
+}
+
+CameraPath::CameraPath(const std::string& filepath) {
+    QFile file(QString::fromStdString(filepath));
+    if (!file.open(QIODevice::ReadOnly)) throw std::runtime_error("Failed to open camera path: " + filepath);
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+
+    if (doc.isNull()) {
+        throw std::runtime_error("Failed to parse camera path: " + filepath + ": " + error.errorString().toStdString());
+    }
+
+    for (const QJsonValue& value : doc.object()["keyframes"].toArray()) {
+        QJsonObject keyframe = value.toObject();
+
+        if (!keyframe["time"].isDouble() || !keyframe.contains("position")) {
+            throw std::runtime_error("Camera path keyframe needs \"time\" and \"position\"");
+        }
+
+        if (keyframe.contains("look") == keyframe.contains("focus")) {
+            throw std::runtime_error("Camera path keyframe needs one of \"look\" or \"focus\"");
+        }
+
+        glm::vec3 pos = toVec3(keyframe["position"], "position");
+        glm::vec3 look = keyframe.contains("look") ? toVec3(keyframe["look"], "look")
+                                                   : toVec3(keyframe["focus"], "focus") - pos;
+        glm::vec3 up = keyframe.contains("up") ? toVec3(keyframe["up"], "up") : glm::vec3{0.f, 1.f, 0.f};
+
+        m_keyframes.push_back({static_cast<float>(keyframe["time"].toDouble()), pos, glm::normalize(look), glm::normalize(up)});
+    }
+
+    if (m_keyframes.empty()) throw std::runtime_error("Camera path has no keyframes: " + filepath);
+
+    std::stable_sort(m_keyframes.begin(), m_keyframes.end(),
+                     [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+}
+
+bool CameraPath::empty() const {
+    return m_keyframes.empty();
+}
+
+CameraPath::Keyframe CameraPath::sample(float t) const {
+    if (t <= m_keyframes.front().time) return m_keyframes.front();
+    if (t >= m_keyframes.back().time) return m_keyframes.back();
+
+    // First keyframe after t, the one before it starts the segment
+    auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), t,
+                                 [](float time, const Keyframe& k) { return time < k.time; });
+    const Keyframe& a = *(next - 1);
+    const Keyframe& b = *next;
+
+    float s = (t - a.time) / (b.time - a.time);
+
+    // Directions are lerped then renormalized, close enough to slerp for dense keyframes
+    return Keyframe{t,
+                    glm::mix(a.pos, b.pos, s),
+                    glm::normalize(glm::mix(a.look, b.look, s)),
+                    glm::normalize(glm::mix(a.up, b.up, s))};
+}
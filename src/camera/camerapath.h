@@ -0,0 +1,34 @@
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Timed camera keyframes for scripted flythroughs, read from a JSON file of the form
+// {"keyframes": [{"time": 0, "position": [x, y, z], "look": [x, y, z], "up": [x, y, z]}, ...]}
+// where "focus" may replace "look" and "up" defaults to +y
+class CameraPath
+{
+public:
+    struct Keyframe {
+        float time;
+        glm::vec3 pos;
+        glm::vec3 look;
+        glm::vec3 up;
+    };
+
+    CameraPath() {}
+
+    CameraPath(const std::string& filepath);
+
+    bool empty() const;
+
+    // camera at time t, held at the first and last keyframe outside the path
+    Keyframe sample(float t) const;
+
+private:
+    std::vector<Keyframe> m_keyframes; // sorted by time
+};
+
+#endif // CAMERAPATH_H
@@ -0,0 +1,79 @@
+#include "frustum.h"
+
+void BoundsSoA::resize(size_t n) {
+    centerX.resize(n), centerY.resize(n), centerZ.resize(n);
+    extentX.resize(n), extentY.resize(n), extentZ.resize(n);
+}
+
+void BoundsSoA::set(size_t i, const glm::vec3& center, const glm::vec3& extent) {
+    centerX[i] = center.x, centerY[i] = center.y, centerZ[i] = center.z;
+    extentX[i] = extent.x, extentY[i] = extent.y, extentZ[i] = extent.z;
+}
+
+size_t BoundsSoA::size() const {
+    return centerX.size();
+}
+
+Frustum::Frustum(const glm::mat4& viewProj) {
+    // rows of clip matrix (glm is column major)
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i) row[i] = {viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]};
+
+    // Gribb-Hartmann plane extraction for [-1, 1] clip space
+    m_planes = {
+        row[3] + row[0],
+        row[3] - row[0],
+        row[3] + row[1],
+        row[3] - row[1],
+        row[3] + row[2],
+        row[3] - row[2]
+    };
+
+    // normalize so offsets are in world units
+    for (glm::vec4& plane : m_planes) plane /= glm::length(glm::vec3{plane});
+}
+
+Containment Frustum::classify(const glm::vec3& center, const glm::vec3& extent) const {
+    Containment result = Containment::CONTAINMENT_INSIDE;
+
+    for (const glm::vec4& plane : m_planes) {
+        float dist = glm::dot(glm::vec3{plane}, center) + plane.w;
+        float radius = glm::dot(glm::abs(glm::vec3{plane}), extent);
+
+        // fully behind any plane means outside
+        if (dist + radius < 0.f) return Containment::CONTAINMENT_OUTSIDE;
+
+        // straddling a plane means partially inside
+        if (dist - radius < 0.f) result = Containment::CONTAINMENT_INTERSECT;
+    }
+
+    return result;
+}
+
+void Frustum::cull(const BoundsSoA& bounds, std::vector<uint8_t>& visible) const {
+    const size_t n = bounds.size();
+
+    visible.assign(n, 1);
+
+    const float* cx = bounds.centerX.data();
+    const float* cy = bounds.centerY.data();
+    const float* cz = bounds.centerZ.data();
+    const float* ex = bounds.extentX.data();
+    const float* ey = bounds.extentY.data();
+    const float* ez = bounds.extentZ.data();
+    uint8_t* out = visible.data();
+
+    // one plane at a time over contiguous arrays, so the inner loop vectorizes
+    for (const glm::vec4& plane : m_planes) {
+        const float nx = plane.x, ny = plane.y, nz = plane.z, w = plane.w;
+        const float ax = glm::abs(nx), ay = glm::abs(ny), az = glm::abs(nz);
+
+        for (size_t i = 0; i < n; ++i) {
+            // signed distance of center plus projected radius of box onto plane normal
+            float dist = nx * cx[i] + ny * cy[i] + nz * cz[i] + w;
+            float radius = ax * ex[i] + ay * ey[i] + az * ez[i];
+
+            out[i] &= static_cast<uint8_t>(dist + radius >= 0.f);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// World space AABBs in center/extent form, one array per component
+struct BoundsSoA {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    void resize(size_t n);
+
+    void set(size_t i, const glm::vec3& center, const glm::vec3& extent);
+
+    size_t size() const;
+};
+
+enum class Containment {
+    CONTAINMENT_OUTSIDE,
+    CONTAINMENT_INTERSECT,
+    CONTAINMENT_INSIDE
+};
+
+class Frustum
+{
+public:
+    Frustum(const glm::mat4& viewProj);
+
+    // classify a single box given in center/extent form
+    Containment classify(const glm::vec3& center, const glm::vec3& extent) const;
+
+    // writes 1 for every box that intersects the frustum, 0 otherwise
+    void cull(const BoundsSoA& bounds, std::vector<uint8_t>& visible) const;
+
+private:
+    // left, right, bottom, top, near, far (xyz = normal, w = offset)
+    std::array<glm::vec4, 6> m_planes;
+};
+
+#endif // FRUSTUM_H
@@ -0,0 +1,269 @@
+#include "occlusionbuffer.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include "utils/profiler.h"
+#include "utils/threadpool.h"
+
+namespace
+{
+    // corners of the unit cube the cube primitive is tessellated from
+    constexpr std::array<glm::vec3, 8> CUBE_CORNERS = {
+        glm::vec3{-0.5f, -0.5f, -0.5f}, glm::vec3{0.5f, -0.5f, -0.5f},
+        glm::vec3{-0.5f,  0.5f, -0.5f}, glm::vec3{0.5f,  0.5f, -0.5f},
+        glm::vec3{-0.5f, -0.5f,  0.5f}, glm::vec3{0.5f, -0.5f,  0.5f},
+        glm::vec3{-0.5f,  0.5f,  0.5f}, glm::vec3{0.5f,  0.5f,  0.5f}
+    };
+
+    // two triangles per face, winding is irrelevant since depth only keeps the nearest
+    constexpr std::array<int, 36> CUBE_INDEXES = {
+        0, 1, 3,  0, 3, 2, // -z
+        4, 6, 7,  4, 7, 5, // +z
+        0, 2, 6,  0, 6, 4, // -x
+        1, 5, 7,  1, 7, 3, // +x
+        0, 4, 5,  0, 5, 1, // -y
+        2, 3, 7,  2, 7, 6  // +y
+    };
+
+    // clip space to texel x, texel y, NDC depth
+    glm::vec3 toScreen(const glm::vec4& clip) {
+        glm::vec3 ndc = glm::vec3{clip} / clip.w;
+
+        return glm::vec3{(ndc.x * 0.5f + 0.5f) * OcclusionBuffer::WIDTH,
+                         (ndc.y * 0.5f + 0.5f) * OcclusionBuffer::HEIGHT,
+                         ndc.z};
+    }
+
+    // twice the signed area of abp
+    float edge(const glm::vec3& a, const glm::vec3& b, float px, float py) {
+        return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+    }
+}
+
+void OcclusionBuffer::setOccluders(const std::vector<glm::mat4>& occluders) {
+    m_occluders = occluders;
+}
+
+void OcclusionBuffer::render(const glm::mat4& viewProj) {
+    wait();
+
+    m_viewProj = viewProj;
+
+    auto pending = std::make_shared<PendingRender>();
+    m_pending = pending;
+
+    // A worker that starts after the render thread claimed the work finds nothing to do
+    ThreadPool::instance().submit([this, pending]() {
+        if (pending->claimed.exchange(true)) return;
+
+        rasterize();
+        pending->done.set_value();
+    });
+}
+
+void OcclusionBuffer::wait() {
+    if (!m_pending) return;
+
+    // Pool may be busy cooking textures, rather do the work here than stall on it
+    if (!m_pending->claimed.exchange(true)) {
+        rasterize();
+    } else {
+        m_pending->done.get_future().wait();
+    }
+
+    m_pending.reset();
+}
+
+void OcclusionBuffer::rasterize() {
+    PROFILE_ZONE("OcclusionBuffer::rasterize");
+
+    std::vector<float>& depth = m_levels.empty() ? m_levels.emplace_back() : m_levels[0];
+    depth.assign(WIDTH * HEIGHT, 1.f);
+
+    m_numRasterized = 0;
+
+    for (const glm::mat4& ctm : m_occluders) {
+        glm::mat4 clipCtm = m_viewProj * ctm;
+
+        // Skip occluders too small on screen to be worth their triangles, near plane crossers are always large
+        glm::vec3 center{ctm[3]};
+        glm::vec3 extent = glm::abs(glm::vec3{ctm[0]}) * 0.5f + glm::abs(glm::vec3{ctm[1]}) * 0.5f + glm::abs(glm::vec3{ctm[2]}) * 0.5f;
+        glm::vec2 lo, hi;
+        float minZ;
+
+        if (projectBox(center, extent, lo, hi, minZ)) {
+            glm::vec2 size = glm::clamp(hi, glm::vec2{0.f}, glm::vec2{WIDTH, HEIGHT}) -
+                             glm::clamp(lo, glm::vec2{0.f}, glm::vec2{WIDTH, HEIGHT});
+
+            if (size.x * size.y < MIN_OCCLUDER_AREA || minZ > 1.f) continue;
+        }
+
+        std::array<glm::vec4, 8> clip;
+        for (int i = 0; i < 8; ++i) clip[i] = clipCtm * glm::vec4{CUBE_CORNERS[i], 1.f};
+
+        for (int i = 0; i < CUBE_INDEXES.size(); i += 3) {
+            rasterizeClipped(clip[CUBE_INDEXES[i]], clip[CUBE_INDEXES[i + 1]], clip[CUBE_INDEXES[i + 2]]);
+        }
+
+        m_numRasterized++;
+    }
+
+    buildPyramid();
+}
+
+void OcclusionBuffer::rasterizeClipped(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+    // Clip against the near plane z = -w, the rest is handled by the screen bounds
+    std::array<glm::vec4, 3> in = {a, b, c};
+    std::array<glm::vec4, 4> out;
+    int count = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec4& curr = in[i];
+        const glm::vec4& next = in[(i + 1) % 3];
+        float currDist = curr.z + curr.w;
+        float nextDist = next.z + next.w;
+
+        if (currDist >= 0.f) out[count++] = curr;
+        if ((currDist >= 0.f) != (nextDist >= 0.f)) out[count++] = glm::mix(curr, next, currDist / (currDist - nextDist));
+    }
+
+    if (count < 3) return;
+
+    // Clipped triangle is a fan of one or two triangles
+    glm::vec3 s0 = toScreen(out[0]);
+    for (int i = 1; i + 1 < count; ++i) rasterizeTriangle(s0, toScreen(out[i]), toScreen(out[i + 1]));
+}
+
+void OcclusionBuffer::rasterizeTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    float area = edge(a, b, c.x, c.y);
+    if (glm::abs(area) < 1e-6f) return;
+
+    // Flip so covered texels have non-negative edge values for either winding
+    float sign = area > 0.f ? 1.f : -1.f;
+    float invArea = 1.f / glm::abs(area);
+
+    int x0 = std::max(0, static_cast<int>(glm::floor(std::min({a.x, b.x, c.x}))));
+    int x1 = std::min(WIDTH - 1, static_cast<int>(glm::ceil(std::max({a.x, b.x, c.x}))));
+    int y0 = std::max(0, static_cast<int>(glm::floor(std::min({a.y, b.y, c.y}))));
+    int y1 = std::min(HEIGHT - 1, static_cast<int>(glm::ceil(std::max({a.y, b.y, c.y}))));
+
+    if (x0 > x1 || y0 > y1) return;
+
+    // Edge functions step by a constant per texel, so each row is a straight line of adds
+    float stepX0 = -(c.y - b.y) * sign, stepX1 = -(a.y - c.y) * sign, stepX2 = -(b.y - a.y) * sign;
+
+    std::vector<float>& depth = m_levels[0];
+
+    for (int y = y0; y <= y1; ++y) {
+        float py = y + 0.5f;
+        float px = x0 + 0.5f;
+
+        float w0 = edge(b, c, px, py) * sign;
+        float w1 = edge(c, a, px, py) * sign;
+        float w2 = edge(a, b, px, py) * sign;
+
+        float* row = &depth[y * WIDTH];
+
+        for (int x = x0; x <= x1; ++x) {
+            float z = (w0 * a.z + w1 * b.z + w2 * c.z) * invArea;
+            bool covered = w0 >= 0.f && w1 >= 0.f && w2 >= 0.f;
+
+            row[x] = covered ? std::min(row[x], z) : row[x];
+
+            w0 += stepX0;
+            w1 += stepX1;
+            w2 += stepX2;
+        }
+    }
+}
+
+void OcclusionBuffer::buildPyramid() {
+    m_levels.resize(1);
+    m_levelSizes.assign(1, glm::ivec2{WIDTH, HEIGHT});
+
+    while (m_levelSizes.back() != glm::ivec2{1, 1}) {
+        glm::ivec2 src = m_levelSizes.back();
+        glm::ivec2 dst = glm::max(src / 2, glm::ivec2{1});
+
+        std::vector<float> level(dst.x * dst.y);
+        const std::vector<float>& below = m_levels.back();
+
+        // Farthest of the 2x2 below, so a box nearer than a texel is nearer than everything it covers
+        for (int y = 0; y < dst.y; ++y) {
+            int sy0 = std::min(2 * y, src.y - 1) * src.x;
+            int sy1 = std::min(2 * y + 1, src.y - 1) * src.x;
+
+            for (int x = 0; x < dst.x; ++x) {
+                int sx0 = std::min(2 * x, src.x - 1);
+                int sx1 = std::min(2 * x + 1, src.x - 1);
+
+                level[y * dst.x + x] = std::max({below[sy0 + sx0], below[sy0 + sx1], below[sy1 + sx0], below[sy1 + sx1]});
+            }
+        }
+
+        m_levels.push_back(std::move(level));
+        m_levelSizes.push_back(dst);
+    }
+}
+
+bool OcclusionBuffer::projectBox(const glm::vec3& center, const glm::vec3& extent,
+                                 glm::vec2& lo, glm::vec2& hi, float& minZ) const
+{
+    lo = glm::vec2{std::numeric_limits<float>::max()};
+    hi = glm::vec2{std::numeric_limits<float>::lowest()};
+    minZ = std::numeric_limits<float>::max();
+
+    for (const glm::vec3& corner : CUBE_CORNERS) {
+        glm::vec4 clip = m_viewProj * glm::vec4{center + corner * 2.f * extent, 1.f};
+
+        // Projection flips behind the near plane, bounds would be wrong
+        if (clip.z < -clip.w || clip.w <= 0.f) return false;
+
+        glm::vec3 screen = toScreen(clip);
+        lo = glm::min(lo, glm::vec2{screen});
+        hi = glm::max(hi, glm::vec2{screen});
+        minZ = std::min(minZ, screen.z);
+    }
+
+    return true;
+}
+
+bool OcclusionBuffer::isOccluded(const glm::vec3& center, const glm::vec3& extent) const {
+    if (m_levels.empty() || m_numRasterized == 0) return false;
+
+    glm::vec2 lo, hi;
+    float minZ;
+
+    if (!projectBox(center, extent, lo, hi, minZ)) return false;
+
+    // Off screen boxes are left to the frustum test
+    if (hi.x < 0.f || hi.y < 0.f || lo.x >= WIDTH || lo.y >= HEIGHT) return false;
+
+    // Occluders cover whole texels whose centers they contain, so a box up to half a texel past an edge
+    // lands in covered texels. Test one texel further out so the neighbour outside the occluder is read
+    lo -= glm::vec2{1.f};
+    hi += glm::vec2{1.f};
+
+    glm::ivec2 p0 = glm::clamp(glm::ivec2{glm::floor(lo)}, glm::ivec2{0}, glm::ivec2{WIDTH - 1, HEIGHT - 1});
+    glm::ivec2 p1 = glm::clamp(glm::ivec2{glm::floor(hi)}, glm::ivec2{0}, glm::ivec2{WIDTH - 1, HEIGHT - 1});
+
+    // Coarsest detail where the bounds still span at most 2x2 texels
+    int level = 0;
+    while ((p1.x >> level) - (p0.x >> level) > 1 || (p1.y >> level) - (p0.y >> level) > 1) level++;
+
+    const std::vector<float>& depth = m_levels[level];
+    int width = m_levelSizes[level].x;
+    float maxDepth = -1.f;
+
+    for (int y = p0.y >> level; y <= p1.y >> level; ++y) {
+        for (int x = p0.x >> level; x <= p1.x >> level; ++x) {
+            maxDepth = std::max(maxDepth, depth[y * width + x]);
+        }
+    }
+
+    return minZ > maxDepth;
+}
+
+int OcclusionBuffer::getNumRasterized() const {
+    return m_numRasterized;
+}
@@ -0,0 +1,64 @@
+#ifndef OCCLUSIONBUFFER_H
+#define OCCLUSIONBUFFER_H
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Low resolution depth buffer of a few large occluders, rasterized on the CPU
+// boxes are tested against a max depth pyramid so each test reads at most 2x2 texels
+class OcclusionBuffer
+{
+public:
+    static constexpr int WIDTH = 256;
+    static constexpr int HEIGHT = 128;
+
+    // occluders covering fewer texels than this rarely hide anything and are skipped
+    static constexpr float MIN_OCCLUDER_AREA = 64.f;
+
+    OcclusionBuffer() {}
+
+    // unit cubes given by their object to world transforms
+    void setOccluders(const std::vector<glm::mat4>& occluders);
+
+    // start rasterizing occluders seen from viewProj on the pool, the caller keeps working meanwhile
+    void render(const glm::mat4& viewProj);
+
+    // block until the last render finished, rasterizing on the calling thread if no worker started it yet
+    void wait();
+
+    // box in center/extent form is certainly hidden, only valid after wait
+    bool isOccluded(const glm::vec3& center, const glm::vec3& extent) const;
+
+    // occluders rasterized by the last render
+    int getNumRasterized() const;
+
+private:
+    // render handed to the pool, whichever thread claims it first does the work
+    struct PendingRender {
+        std::atomic<bool> claimed{false};
+        std::promise<void> done;
+    };
+
+    glm::mat4 m_viewProj{1.f};
+    std::vector<glm::mat4> m_occluders;
+    std::shared_ptr<PendingRender> m_pending;
+    int m_numRasterized = 0;
+
+    // level 0 holds nearest NDC depth per texel, every level above the farthest of the 2x2 below
+    std::vector<std::vector<float>> m_levels;
+    std::vector<glm::ivec2> m_levelSizes;
+
+    void rasterize();
+    void rasterizeClipped(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+    void rasterizeTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+    void buildPyramid();
+
+    // screen space bounds in texels and nearest NDC depth, false if the box crosses the near plane
+    bool projectBox(const glm::vec3& center, const glm::vec3& extent,
+                    glm::vec2& lo, glm::vec2& hi, float& minZ) const;
+};
+
+#endif // OCCLUSIONBUFFER_H
@@ -1,11 +1,15 @@
 #include "geometry.h"
+#include <algorithm>
+#include <cstddef>
+#include "utils/stats.h"
 
-Geometry::Geometry(std::unique_ptr<Primitive> prim) :
-    m_prim(std::move(prim))
-{
+using VertexFormat::PackedVertex;
+
+Geometry::Geometry(const Tessellation& tess) {
     glGenBuffers(1, &m_vbo);
+    glGenBuffers(1, &m_ebo);
     glGenVertexArrays(1, &m_vao);
-    genPrim();
+    genPrim(tess);
 }
 
 Geometry::Geometry(std::unique_ptr<Mesh> mesh) :
@@ -17,18 +21,43 @@ Geometry::Geometry(std::unique_ptr<Mesh> mesh) :
     genMesh();
 }
 
-void Geometry::updateParams(int param1, int param2) {
-    if (!m_prim) return;
-    m_prim->updateParams(param1, param2);
-    genPrim();
+void Geometry::update(const Tessellation& tess) {
+    if (m_mesh) return;
+    genPrim(tess);
+}
+
+const GLuint Geometry::getId() const {
+    return m_vao;
+}
+
+int Geometry::getLodCount() const {
+    return m_lods.size();
 }
 
 void Geometry::draw() const {
     glBindVertexArray(m_vao);
 
-    m_prim ?
-        glDrawArrays(GL_TRIANGLES, 0, m_numVertices) :
-        glDrawElements(GL_TRIANGLES, m_numIndexes, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, m_lods[0].count, m_indexType, 0);
+
+    stats.drawCalls++;
+    stats.triangles += m_lods[0].count / 3;
+
+    glBindVertexArray(0);
+}
+
+void Geometry::drawInstanced(const InstanceBuffer& instances, int first, int count, int lod) const {
+    const IndexRange& range = m_lods[lod];
+    size_t indexSize = m_indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+
+    glBindVertexArray(m_vao);
+
+    // point per-instance attribs at this batch's instances
+    instances.bindAttribs(first);
+
+    glDrawElementsInstanced(GL_TRIANGLES, range.count, m_indexType, reinterpret_cast<void*>(range.offset * indexSize), count);
+
+    stats.drawCalls++;
+    stats.triangles += range.count / 3 * count;
 
     glBindVertexArray(0);
 }
@@ -36,64 +65,60 @@ void Geometry::draw() const {
 void Geometry::clean() {
     glDeleteBuffers(1, &m_vbo);
     glDeleteBuffers(1, &m_ebo);
+    glDeleteBuffers(1, &m_skinVbo);
     glDeleteVertexArrays(1, &m_vao);
 }
 
-void Geometry::genPrim() {
-    const std::vector<float>& primData = m_prim->generateShape();
+void Geometry::genPrim(const Tessellation& tess) {
+    const std::vector<float>& primData = tess.vertexData;
+    const std::vector<unsigned int>& indexes = tess.indexes;
 
-    // init no of vertices
-    m_numVertices = primData.size() / stride;
+    // pack 14-float vertices into compact layout
+    std::vector<PackedVertex> packed;
+    packed.reserve(primData.size() / stride);
 
-    // // VBO
-    // bind VBO
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    for (size_t v = 0; v < primData.size(); v += stride) {
+        const float* vertex = &primData[v];
 
-    // fill VBO with data
-    glBufferData(GL_ARRAY_BUFFER, primData.size() * sizeof(GLfloat), primData.data(), GL_STATIC_DRAW);
+        packed.push_back(VertexFormat::pack(glm::vec3{vertex[0], vertex[1], vertex[2]},
+                                            glm::vec3{vertex[3], vertex[4], vertex[5]},
+                                            glm::vec2{vertex[6], vertex[7]},
+                                            glm::vec3{vertex[8], vertex[9], vertex[10]},
+                                            glm::vec3{vertex[11], vertex[12], vertex[13]}));
+    }
 
-    // // VAO
-    // bind VAO
+    // bind all (VAO first)
     glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
 
-    // set VAO attribs
-    // position attrib = 0
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, // index in shader
-                          3, // number of vals in attrib
-                          GL_FLOAT, // type of val in attrib
-                          GL_FALSE, // do not normalize to [-1, 1] or [0, 1]
-                          stride * sizeof(GLfloat), // size (in bytes) between vertices
-                          reinterpret_cast<void*>(0 * sizeof(GLfloat))); // offset (in bytes) from vertex start
-
-    // normal attrib = 1
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride * sizeof(GLfloat), reinterpret_cast<void*>(3 * sizeof(GLfloat)));
-
-    // texture attrib = 2
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride * sizeof(GLfloat), reinterpret_cast<void*>(6 * sizeof(GLfloat)));
+    // populate VBO with welded vertices
+    glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+    stats.bytesUploaded += packed.size() * sizeof(PackedVertex);
 
-    // tangent attrib = 3
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride * sizeof(GLfloat), reinterpret_cast<void*>(8 * sizeof(GLfloat)));
+    // populate EBO, primitive LODs are separate geometries
+    uploadIndexes({&indexes}, packed.size());
 
-    // bitangent attrib = 4
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride * sizeof(GLfloat), reinterpret_cast<void*>(11 * sizeof(GLfloat)));
+    // set VAO attribs
+    setPackedAttribs();
 
-    // unbind VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    // unbind VAO
+    // unbind all (VAO first)
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void Geometry::genMesh() {
     const std::vector<Vertex>& meshData = m_mesh->getVertices();
     const std::vector<unsigned int>& indexes = m_mesh->getIndexes();
 
-    // init no of indexes
-    m_numIndexes = indexes.size();
+    // pack vertices into compact layout
+    std::vector<PackedVertex> packed;
+    packed.reserve(meshData.size());
+
+    for (const Vertex& vertex : meshData) {
+        packed.push_back(VertexFormat::pack(vertex.pos, vertex.norm, vertex.uv, vertex.tang, vertex.bitang));
+    }
 
     // bind all (VAO first)
     glBindVertexArray(m_vao);
@@ -101,43 +126,107 @@ void Geometry::genMesh() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
 
     // populate VBO
-    glBufferData(GL_ARRAY_BUFFER, meshData.size() * sizeof(Vertex), meshData.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+    stats.bytesUploaded += packed.size() * sizeof(PackedVertex);
+
+    // populate EBO with full resolution followed by every simplified level
+    std::vector<const std::vector<unsigned int>*> lods{&indexes};
+    for (const auto& lod : m_mesh->getLodIndexes()) lods.push_back(&lod);
 
-    // populate EBO
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexes.size() * sizeof(GLuint), indexes.data(), GL_STATIC_DRAW);
+    uploadIndexes(lods, packed.size());
 
     // set VAO attribs
-    // position attrib = 0
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, pos)));
+    setPackedAttribs();
 
-    // normal attrib = 1
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, norm)));
+    // skinning stream is only allocated for meshes with bone weights
+    bool skinned = std::any_of(meshData.begin(), meshData.end(), [](const Vertex& vertex) {
+        return vertex.weights[0] > 0.f;
+    });
 
-    // texture attrib = 2
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, uv)));
+    if (skinned) {
+        int maxBone = 0;
+        for (const Vertex& vertex : meshData) {
+            maxBone = std::max(maxBone, *std::max_element(vertex.boneIDs.begin(), vertex.boneIDs.end()));
+        }
 
-    // tangent attrib = 3
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, tang)));
+        // uint8 bone indexes unless skeleton is too large
+        maxBone < 256 ? genSkin<uint8_t>(meshData, GL_UNSIGNED_BYTE) :
+                        genSkin<uint16_t>(meshData, GL_UNSIGNED_SHORT);
+    }
+
+    // unbind all (VAO first)
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
 
-    // bitangent attrib = 4
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, bitang)));
+template <typename T>
+void Geometry::genSkin(const std::vector<Vertex>& meshData, GLenum idType) {
+    using Skin = VertexFormat::SkinVertex<T>;
+
+    std::vector<Skin> skins;
+    skins.reserve(meshData.size());
+
+    for (const Vertex& vertex : meshData) skins.push_back(VertexFormat::packSkin<T>(vertex));
+
+    glGenBuffers(1, &m_skinVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_skinVbo);
+    glBufferData(GL_ARRAY_BUFFER, skins.size() * sizeof(Skin), skins.data(), GL_STATIC_DRAW);
+    stats.bytesUploaded += skins.size() * sizeof(Skin);
 
     // bone ID attrib = 5
     // NOTE: using glVertexAttrib*I*Pointer, not glVertexAttribPointer
     glEnableVertexAttribArray(5);
-    glVertexAttribIPointer(5, MAX_WEIGHTS, GL_INT, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, boneIDs)));
+    glVertexAttribIPointer(5, MAX_WEIGHTS, idType, sizeof(Skin), reinterpret_cast<void*>(offsetof(Skin, boneIDs)));
 
-    // bone weight attrib = 6
+    // bone weight attrib = 6, unorm8 -> [0, 1]
     glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, MAX_WEIGHTS, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, weights)));
+    glVertexAttribPointer(6, MAX_WEIGHTS, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Skin), reinterpret_cast<void*>(offsetof(Skin, weights)));
+}
 
-    // unbind all (VAO first)
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+void Geometry::uploadIndexes(const std::vector<const std::vector<unsigned int>*>& lods, size_t numVertices) {
+    // concatenate levels, recording each range
+    std::vector<unsigned int> indexes;
+    m_lods.clear();
+
+    for (const std::vector<unsigned int>* lod : lods) {
+        m_lods.push_back({indexes.size(), lod->size()});
+        indexes.insert(indexes.end(), lod->begin(), lod->end());
+    }
+
+    // 16-bit indexes when every vertex is addressable
+    if (numVertices < 65536) {
+        std::vector<GLushort> shortIndexes{indexes.begin(), indexes.end()};
+
+        m_indexType = GL_UNSIGNED_SHORT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndexes.size() * sizeof(GLushort), shortIndexes.data(), GL_STATIC_DRAW);
+        stats.bytesUploaded += shortIndexes.size() * sizeof(GLushort);
+    } else {
+        m_indexType = GL_UNSIGNED_INT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexes.size() * sizeof(GLuint), indexes.data(), GL_STATIC_DRAW);
+        stats.bytesUploaded += indexes.size() * sizeof(GLuint);
+    }
+}
+
+void Geometry::setPackedAttribs() {
+    // position attrib = 0
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, // index in shader
+                          3, // number of vals in attrib
+                          GL_FLOAT, // type of val in attrib
+                          GL_FALSE, // do not normalize to [-1, 1] or [0, 1]
+                          sizeof(PackedVertex), // size (in bytes) between vertices
+                          reinterpret_cast<void*>(offsetof(PackedVertex, pos))); // offset (in bytes) from vertex start
+
+    // normal attrib = 1, snorm 10:10:10:2 -> [-1, 1]
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), reinterpret_cast<void*>(offsetof(PackedVertex, norm)));
+
+    // texture attrib = 2, half floats
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), reinterpret_cast<void*>(offsetof(PackedVertex, uv)));
+
+    // tangent attrib = 3, snorm 10:10:10:2 with bitangent sign in w
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), reinterpret_cast<void*>(offsetof(PackedVertex, tang)));
 }
@@ -4,35 +4,58 @@
 #include <GL/glew.h>
 #include <memory>
 #include "primitive/primitive.h"
+#include "buffer/instancebuffer.h"
 #include "mesh.h"
+#include "vertexformat.h"
 
 class Geometry
 {
 public:
-    Geometry(std::unique_ptr<Primitive> prim);
+    Geometry(const Tessellation& tess);
 
     Geometry(std::unique_ptr<Mesh> mesh);
 
-    void updateParams(int param1, int param2);
+    // re-upload primitive buffers with new tessellation
+    void update(const Tessellation& tess);
+
+    const GLuint getId() const;
+
+    // number of index ranges, level 0 is full resolution
+    int getLodCount() const;
 
     void draw() const;
 
+    void drawInstanced(const InstanceBuffer& instances, int first, int count, int lod = 0) const;
+
     void clean();
 
 private:
-    // primitive data + func
-    std::unique_ptr<Primitive> m_prim;
-    size_t m_numVertices;
-    void genPrim();
+    // primitive func
+    void genPrim(const Tessellation& tess);
 
     // mesh data + func
     std::unique_ptr<Mesh> m_mesh;
-    size_t m_numIndexes;
     void genMesh();
 
-    GLuint m_vbo; // vertex buffer obj
-    GLuint m_ebo; // element buffer obj
-    GLuint m_vao; // vertex array obj
+    // both primitives and meshes draw indexed, mesh LODs are ranges of one index buffer
+    struct IndexRange {
+        size_t offset; // in indexes
+        size_t count;
+    };
+
+    std::vector<IndexRange> m_lods;
+    GLenum m_indexType = GL_UNSIGNED_INT;
+    void uploadIndexes(const std::vector<const std::vector<unsigned int>*>& lods, size_t numVertices);
+
+    // packed vertex attribs + skinning stream
+    void setPackedAttribs();
+    template <typename T>
+    void genSkin(const std::vector<Vertex>& meshData, GLenum idType);
+
+    GLuint m_vbo;         // vertex buffer obj
+    GLuint m_skinVbo = 0; // skinning vertex buffer obj, skinned meshes only
+    GLuint m_ebo;         // element buffer obj
+    GLuint m_vao;         // vertex array obj
 
     // 3 vert + 3 norm + 2 uv + 3 tang + 3 bitang
     int stride = 14;
@@ -0,0 +1,247 @@
+#include "indexoptimizer.h"
+#include <algorithm>
+#include <deque>
+
+namespace IndexOptimizer
+{
+
+    CacheStats analyze(const std::vector<unsigned int>& indexes, size_t numVertices, int cacheSize) {
+        std::deque<unsigned int> cache;
+        std::vector<char> inCache(numVertices, 0);
+        std::vector<char> referenced(numVertices, 0);
+        size_t misses = 0;
+        size_t numReferenced = 0;
+
+        for (unsigned int v : indexes) {
+            if (!referenced[v]) {
+                referenced[v] = 1;
+                numReferenced++;
+            }
+
+            if (inCache[v]) continue;
+
+            // FIFO, hits do not refresh an entry
+            misses++;
+            cache.push_back(v);
+            inCache[v] = 1;
+
+            if (cache.size() > cacheSize) {
+                inCache[cache.front()] = 0;
+                cache.pop_front();
+            }
+        }
+
+        size_t numTris = indexes.size() / 3;
+
+        return CacheStats{
+            numTris ? static_cast<float>(misses) / numTris : 0.f,
+            numReferenced ? static_cast<float>(misses) / numReferenced : 0.f
+        };
+    }
+
+    void optimizeVertexCache(std::vector<unsigned int>& indexes,
+                             size_t numVertices,
+                             std::vector<size_t>& clusters,
+                             int cacheSize)
+    {
+        size_t numTris = indexes.size() / 3;
+
+        // Triangles around each vertex
+        std::vector<unsigned int> adjOffsets(numVertices + 1, 0);
+        for (unsigned int v : indexes) adjOffsets[v + 1]++;
+        for (size_t v = 0; v < numVertices; ++v) adjOffsets[v + 1] += adjOffsets[v];
+
+        std::vector<unsigned int> adjTris(indexes.size());
+        std::vector<unsigned int> cursor{adjOffsets.begin(), adjOffsets.end() - 1};
+        for (size_t i = 0; i < indexes.size(); ++i) adjTris[cursor[indexes[i]]++] = i / 3;
+
+        // Live triangle count and cache time stamp of every vertex
+        std::vector<int> live(numVertices);
+        for (size_t v = 0; v < numVertices; ++v) live[v] = adjOffsets[v + 1] - adjOffsets[v];
+
+        std::vector<int> stamp(numVertices, 0);
+        std::vector<char> emitted(numTris, 0);
+        std::vector<unsigned int> deadEnds;
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> result;
+        result.reserve(indexes.size());
+
+        clusters.clear();
+
+        int time = cacheSize + 1;
+        size_t scan = 0; // next vertex to try once the dead end stack runs dry
+        int fan = numVertices ? 0 : -1;
+
+        // Only start a cluster at a vertex that still has triangles
+        auto skipDeadEnd = [&]() -> int {
+            while (!deadEnds.empty()) {
+                unsigned int v = deadEnds.back();
+                deadEnds.pop_back();
+                if (live[v] > 0) return v;
+            }
+
+            for (; scan < numVertices; ++scan) {
+                if (live[scan] > 0) return scan;
+            }
+
+            return -1;
+        };
+
+        if (fan >= 0 && live[fan] == 0) fan = skipDeadEnd();
+        if (fan >= 0) clusters.push_back(0);
+
+        while (fan >= 0) {
+            candidates.clear();
+
+            // Emit every remaining triangle fanning around the current vertex
+            for (unsigned int i = adjOffsets[fan]; i < adjOffsets[fan + 1]; ++i) {
+                unsigned int t = adjTris[i];
+                if (emitted[t]) continue;
+
+                for (int k = 0; k < 3; ++k) {
+                    unsigned int v = indexes[t * 3 + k];
+
+                    result.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+
+                    if (time - stamp[v] > cacheSize) stamp[v] = time++;
+                }
+
+                emitted[t] = 1;
+            }
+
+            // Prefer the oldest candidate that stays in cache while its remaining triangles are emitted
+            int next = -1;
+            int best = -1;
+
+            for (unsigned int v : candidates) {
+                if (live[v] <= 0) continue;
+
+                int priority = 0;
+                if (time - stamp[v] + 2 * live[v] <= cacheSize) priority = time - stamp[v];
+
+                if (priority > best) {
+                    best = priority;
+                    next = v;
+                }
+            }
+
+            // Dead end, the next fan starts cold so it begins a new cluster
+            if (next == -1) {
+                next = skipDeadEnd();
+                if (next >= 0) clusters.push_back(result.size());
+            }
+
+            fan = next;
+        }
+
+        indexes = std::move(result);
+    }
+
+    void optimizeOverdraw(std::vector<unsigned int>& indexes,
+                          const std::vector<Vertex>& vertices,
+                          const std::vector<size_t>& clusters)
+    {
+        if (clusters.size() < 2) return;
+
+        // Area weighted centroid of the whole mesh
+        glm::vec3 meshCentroid{0.f};
+        float meshArea = 0.f;
+
+        struct Cluster {
+            size_t begin, end;
+            float sortKey;
+        };
+
+        std::vector<Cluster> order;
+        order.reserve(clusters.size());
+
+        std::vector<glm::vec3> clusterCentroids;
+        std::vector<glm::vec3> clusterNormals;
+
+        for (size_t c = 0; c < clusters.size(); ++c) {
+            size_t begin = clusters[c];
+            size_t end = c + 1 < clusters.size() ? clusters[c + 1] : indexes.size();
+
+            glm::vec3 centroid{0.f};
+            glm::vec3 normal{0.f};
+            float area = 0.f;
+
+            for (size_t t = begin; t < end; t += 3) {
+                const glm::vec3& p0 = vertices[indexes[t]].pos;
+                const glm::vec3& p1 = vertices[indexes[t + 1]].pos;
+                const glm::vec3& p2 = vertices[indexes[t + 2]].pos;
+
+                // cross product length is twice the area, the factor cancels out
+                glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+                float triArea = glm::length(n);
+
+                centroid += (p0 + p1 + p2) / 3.f * triArea;
+                normal += n;
+                area += triArea;
+            }
+
+            meshCentroid += centroid;
+            meshArea += area;
+
+            clusterCentroids.push_back(area > 0.f ? centroid / area : centroid);
+            clusterNormals.push_back(normal);
+            order.push_back({begin, end, 0.f});
+        }
+
+        if (meshArea > 0.f) meshCentroid /= meshArea;
+
+        // Clusters facing away from the center are likely in front of the rest from any view
+        for (size_t c = 0; c < order.size(); ++c) {
+            glm::vec3 normal = clusterNormals[c];
+            float len = glm::length(normal);
+
+            order[c].sortKey = len > 0.f ? glm::dot(clusterCentroids[c] - meshCentroid, normal / len) : 0.f;
+        }
+
+        std::stable_sort(order.begin(), order.end(), [](const Cluster& l, const Cluster& r) {
+            return l.sortKey > r.sortKey;
+        });
+
+        std::vector<unsigned int> result;
+        result.reserve(indexes.size());
+
+        for (const Cluster& cluster : order) {
+            result.insert(result.end(), indexes.begin() + cluster.begin, indexes.begin() + cluster.end);
+        }
+
+        indexes = std::move(result);
+    }
+
+    void optimizeVertexFetch(std::vector<Vertex>& vertices,
+                             std::vector<unsigned int>& indexes,
+                             std::vector<std::vector<unsigned int>>& lodIndexes)
+    {
+        constexpr unsigned int UNUSED = ~0u;
+
+        std::vector<unsigned int> remap(vertices.size(), UNUSED);
+        unsigned int next = 0;
+
+        for (unsigned int v : indexes) {
+            if (remap[v] == UNUSED) remap[v] = next++;
+        }
+
+        // Vertices only coarser levels reference, if any, go last
+        for (unsigned int& v : remap) {
+            if (v == UNUSED) v = next++;
+        }
+
+        std::vector<Vertex> reordered(vertices.size());
+        for (size_t v = 0; v < vertices.size(); ++v) reordered[remap[v]] = vertices[v];
+
+        vertices = std::move(reordered);
+
+        for (unsigned int& v : indexes) v = remap[v];
+        for (auto& lod : lodIndexes) {
+            for (unsigned int& v : lod) v = remap[v];
+        }
+    }
+
+}
@@ -0,0 +1,38 @@
+#ifndef INDEXOPTIMIZER_H
+#define INDEXOPTIMIZER_H
+
+#include <vector>
+#include "utils/sceneparser.h"
+
+// Triangle and vertex reordering of indexed meshes for the GPU vertex cache, overdraw and fetch
+namespace IndexOptimizer
+{
+    // Modeled post-transform cache size, in vertices
+    constexpr int CACHE_SIZE = 16;
+
+    struct CacheStats {
+        float acmr; // cache misses per triangle, 0.5 is ideal
+        float atvr; // cache misses per referenced vertex, 1.0 is ideal
+    };
+
+    // Simulate a FIFO post-transform cache over the index list
+    CacheStats analyze(const std::vector<unsigned int>& indexes, size_t numVertices, int cacheSize = CACHE_SIZE);
+
+    // Tipsify triangle order, clusters receives the index offset of every run split by a dead end
+    void optimizeVertexCache(std::vector<unsigned int>& indexes,
+                             size_t numVertices,
+                             std::vector<size_t>& clusters,
+                             int cacheSize = CACHE_SIZE);
+
+    // Order clusters so outward facing ones draw first and occlude the rest, keeps order within clusters
+    void optimizeOverdraw(std::vector<unsigned int>& indexes,
+                          const std::vector<Vertex>& vertices,
+                          const std::vector<size_t>& clusters);
+
+    // Renumber vertices in first use order of indexes, lodIndexes are remapped to match
+    void optimizeVertexFetch(std::vector<Vertex>& vertices,
+                             std::vector<unsigned int>& indexes,
+                             std::vector<std::vector<unsigned int>>& lodIndexes);
+}
+
+#endif // INDEXOPTIMIZER_H
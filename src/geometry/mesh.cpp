@@ -1,9 +1,11 @@
 #include "mesh.h"
 
 Mesh::Mesh(const std::vector<Vertex>& vertexData,
-           const std::vector<unsigned int>& indexes) :
+           const std::vector<unsigned int>& indexes,
+           const std::vector<std::vector<unsigned int>>& lodIndexes) :
     m_vertexData(vertexData),
-    m_indexes(indexes)
+    m_indexes(indexes),
+    m_lodIndexes(lodIndexes)
 {}
 
 const std::vector<Vertex>& Mesh::getVertices() const {
@@ -13,3 +15,7 @@ const std::vector<Vertex>& Mesh::getVertices() const {
 const std::vector<unsigned int>& Mesh::getIndexes() const {
     return m_indexes;
 }
+
+const std::vector<std::vector<unsigned int>>& Mesh::getLodIndexes() const {
+    return m_lodIndexes;
+}
@@ -8,15 +8,19 @@ class Mesh
 {
 public:
     Mesh(const std::vector<Vertex>& vertexData,
-         const std::vector<unsigned int>& indexes);
+         const std::vector<unsigned int>& indexes,
+         const std::vector<std::vector<unsigned int>>& lodIndexes);
 
     const std::vector<Vertex>& getVertices() const;
 
     const std::vector<unsigned int>& getIndexes() const;
 
+    const std::vector<std::vector<unsigned int>>& getLodIndexes() const;
+
 private:
     const std::vector<Vertex>& m_vertexData;
     const std::vector<unsigned int>& m_indexes;
+    const std::vector<std::vector<unsigned int>>& m_lodIndexes;
 };
 
 #endif // MESH_H
@@ -16,7 +16,8 @@ void Model::addMesh(const RenderShapeData& shape) {
     if (!m_meshMap.contains(shape.id)) {
         m_meshMap.emplace(shape.id,
                           Geometry{std::make_unique<Mesh>(shape.vertexData,
-                                                          shape.indexes)});
+                                                          shape.indexes,
+                                                          shape.lodIndexes)});
     }
 }
 
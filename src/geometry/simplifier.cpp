@@ -0,0 +1,270 @@
+#include "simplifier.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    // Smallest cosine between a triangle's normal before and after a collapse
+    constexpr float MIN_NORMAL_COS = 0.25f;
+
+    // Symmetric 4x4 matrix summing squared distances to planes, upper triangle only
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+        double a11 = 0, a12 = 0, a13 = 0;
+        double a22 = 0, a23 = 0;
+        double a33 = 0;
+
+        void addPlane(const glm::dvec3& n, double d) {
+            a00 += n.x * n.x; a01 += n.x * n.y; a02 += n.x * n.z; a03 += n.x * d;
+            a11 += n.y * n.y; a12 += n.y * n.z; a13 += n.y * d;
+            a22 += n.z * n.z; a23 += n.z * d;
+            a33 += d * d;
+        }
+
+        Quadric operator+(const Quadric& q) const {
+            return Quadric{a00 + q.a00, a01 + q.a01, a02 + q.a02, a03 + q.a03,
+                           a11 + q.a11, a12 + q.a12, a13 + q.a13,
+                           a22 + q.a22, a23 + q.a23,
+                           a33 + q.a33};
+        }
+
+        // sum of squared distances from p to every accumulated plane
+        double eval(const glm::vec3& p) const {
+            double x = p.x, y = p.y, z = p.z;
+
+            return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x +
+                   a11 * y * y + 2 * a12 * y * z + 2 * a13 * y +
+                   a22 * z * z + 2 * a23 * z +
+                   a33;
+        }
+    };
+
+    // Collapse of vertex from onto vertex to
+    struct Collapse {
+        unsigned int from, to;
+        double error;
+    };
+
+    // Exact position bits, identical vertices were already joined on import
+    using PosKey = std::array<uint32_t, 3>;
+
+    struct PosKeyHash {
+        size_t operator()(const PosKey& key) const {
+            size_t hash = 0;
+            for (uint32_t k : key) hash = hash * 31 + std::hash<uint32_t>{}(k);
+            return hash;
+        }
+    };
+
+    PosKey toKey(const glm::vec3& pos) {
+        PosKey key;
+        std::memcpy(key.data(), &pos[0], sizeof(key));
+        return key;
+    }
+
+    uint64_t edgeKey(unsigned int a, unsigned int b) {
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    }
+
+    glm::vec3 triNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+        return glm::cross(p1 - p0, p2 - p0);
+    }
+}
+
+namespace Simplifier
+{
+
+    std::vector<unsigned int> simplify(const std::vector<Vertex>& vertices,
+                                       const std::vector<unsigned int>& indexes,
+                                       size_t targetCount,
+                                       float maxError)
+    {
+        const size_t numVertices = vertices.size();
+
+        // Group vertices sharing a position, split only where uv, normal or bone weights differ
+        std::unordered_map<PosKey, unsigned int, PosKeyHash> groupMap;
+        std::vector<unsigned int> group(numVertices);
+        std::vector<int> groupSize;
+
+        for (size_t v = 0; v < numVertices; ++v) {
+            auto [it, inserted] = groupMap.try_emplace(toKey(vertices[v].pos), groupSize.size());
+            if (inserted) groupSize.push_back(0);
+
+            group[v] = it->second;
+            groupSize[it->second]++;
+        }
+
+        // Lock seams so split attributes stay split
+        std::vector<char> locked(numVertices, 0);
+        for (size_t v = 0; v < numVertices; ++v) locked[v] = groupSize[group[v]] > 1;
+
+        // Lock open borders so silhouettes of open meshes keep their outline
+        std::unordered_map<uint64_t, int> edgeCount;
+        for (size_t t = 0; t + 2 < indexes.size(); t += 3) {
+            for (int e = 0; e < 3; ++e) {
+                edgeCount[edgeKey(group[indexes[t + e]], group[indexes[t + (e + 1) % 3]])]++;
+            }
+        }
+
+        for (size_t t = 0; t + 2 < indexes.size(); t += 3) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = indexes[t + e];
+                unsigned int b = indexes[t + (e + 1) % 3];
+
+                if (edgeCount.at(edgeKey(group[a], group[b])) == 1) locked[a] = locked[b] = 1;
+            }
+        }
+
+        // Plane quadric of every position, shared across a seam
+        std::vector<Quadric> quadrics(groupSize.size());
+        for (size_t t = 0; t + 2 < indexes.size(); t += 3) {
+            const glm::vec3& p0 = vertices[indexes[t]].pos;
+            glm::vec3 n = triNormal(p0, vertices[indexes[t + 1]].pos, vertices[indexes[t + 2]].pos);
+
+            float len = glm::length(n);
+            if (len == 0.f) continue;
+
+            glm::dvec3 unitN = glm::dvec3{n / len};
+            double d = -glm::dot(unitN, glm::dvec3{p0});
+
+            for (int k = 0; k < 3; ++k) quadrics[group[indexes[t + k]]].addPlane(unitN, d);
+        }
+
+        std::vector<unsigned int> result = indexes;
+        std::vector<unsigned int> remap(numVertices);
+        std::vector<Collapse> collapses;
+        std::vector<char> touched(numVertices);
+        std::vector<unsigned int> adjOffsets(numVertices + 1);
+        std::vector<unsigned int> adjTris;
+        const double maxErrorSq = static_cast<double>(maxError) * maxError;
+
+        // Each pass collapses an independent set of edges, cheapest first
+        while (result.size() > targetCount) {
+            collapses.clear();
+
+            for (size_t t = 0; t < result.size(); t += 3) {
+                for (int e = 0; e < 3; ++e) {
+                    unsigned int a = result[t + e];
+                    unsigned int b = result[t + (e + 1) % 3];
+                    Quadric q = quadrics[group[a]] + quadrics[group[b]];
+
+                    // Vertex buffer is fixed, so an edge collapses onto one of its endpoints
+                    if (!locked[a]) collapses.push_back({a, b, q.eval(vertices[b].pos)});
+                    if (!locked[b]) collapses.push_back({b, a, q.eval(vertices[a].pos)});
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) {
+                return l.error < r.error;
+            });
+
+            // Triangles around each vertex, for flip checks
+            std::fill(adjOffsets.begin(), adjOffsets.end(), 0);
+            for (unsigned int v : result) adjOffsets[v + 1]++;
+            for (size_t v = 0; v < numVertices; ++v) adjOffsets[v + 1] += adjOffsets[v];
+
+            adjTris.resize(result.size());
+            std::vector<unsigned int> cursor{adjOffsets.begin(), adjOffsets.end() - 1};
+            for (size_t i = 0; i < result.size(); ++i) adjTris[cursor[result[i]]++] = i / 3;
+
+            std::fill(touched.begin(), touched.end(), 0);
+            for (size_t v = 0; v < numVertices; ++v) remap[v] = v;
+
+            // Each collapse removes about two triangles
+            size_t trisToRemove = (result.size() - targetCount) / 3;
+            size_t trisRemoved = 0;
+
+            for (const Collapse& c : collapses) {
+                if (c.error > maxErrorSq || trisRemoved >= trisToRemove) break;
+                if (touched[c.from] || touched[c.to]) continue;
+
+                // Reject collapses that flip a surviving triangle
+                bool flips = false;
+                for (unsigned int i = adjOffsets[c.from]; i < adjOffsets[c.from + 1] && !flips; ++i) {
+                    const unsigned int* tri = &result[adjTris[i] * 3];
+                    if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) continue;
+
+                    std::array<glm::vec3, 3> before, after;
+                    for (int k = 0; k < 3; ++k) {
+                        before[k] = vertices[tri[k]].pos;
+                        after[k] = tri[k] == c.from ? vertices[c.to].pos : before[k];
+                    }
+
+                    // also reject sharp turns, which leave slivers that flip on the next pass
+                    glm::vec3 n0 = triNormal(before[0], before[1], before[2]);
+                    glm::vec3 n1 = triNormal(after[0], after[1], after[2]);
+                    flips = glm::dot(n0, n1) <= MIN_NORMAL_COS * glm::length(n0) * glm::length(n1);
+                }
+
+                if (flips) continue;
+
+                // Freeze the neighborhood so later collapses this pass see valid triangles
+                for (unsigned int i = adjOffsets[c.from]; i < adjOffsets[c.from + 1]; ++i) {
+                    for (int k = 0; k < 3; ++k) touched[result[adjTris[i] * 3 + k]] = 1;
+                }
+
+                remap[c.from] = c.to;
+                quadrics[group[c.to]] = quadrics[group[c.to]] + quadrics[group[c.from]];
+                trisRemoved += 2;
+            }
+
+            if (trisRemoved == 0) break;
+
+            // Rewrite triangles, dropping the ones collapsed to a line
+            size_t write = 0;
+            for (size_t t = 0; t < result.size(); t += 3) {
+                unsigned int a = remap[result[t]];
+                unsigned int b = remap[result[t + 1]];
+                unsigned int c = remap[result[t + 2]];
+
+                if (a == b || b == c || a == c) continue;
+
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+
+            result.resize(write);
+        }
+
+        return result;
+    }
+
+    std::vector<std::vector<unsigned int>> buildLods(const std::vector<Vertex>& vertices,
+                                                     const std::vector<unsigned int>& indexes,
+                                                     int numLevels)
+    {
+        std::vector<std::vector<unsigned int>> lods;
+        if (vertices.empty()) return lods;
+
+        // Error bound grows with the mesh so every model simplifies alike
+        glm::vec3 minPos = vertices[0].pos;
+        glm::vec3 maxPos = vertices[0].pos;
+        for (const Vertex& vertex : vertices) {
+            minPos = glm::min(minPos, vertex.pos);
+            maxPos = glm::max(maxPos, vertex.pos);
+        }
+
+        float diagonal = glm::length(maxPos - minPos);
+        const std::vector<unsigned int>* prev = &indexes;
+
+        for (int level = 1; level < numLevels; ++level) {
+            // 1%, 2%, 4% of the diagonal
+            float maxError = diagonal * 0.01f * static_cast<float>(1 << (level - 1));
+            size_t target = prev->size() / 6 * 3;
+
+            std::vector<unsigned int> lod = simplify(vertices, *prev, target, maxError);
+
+            // Not worth another draw range if less than a tenth of triangles went away
+            if (lod.size() * 10 > prev->size() * 9) break;
+
+            lods.push_back(std::move(lod));
+            prev = &lods.back();
+        }
+
+        return lods;
+    }
+
+}
@@ -0,0 +1,24 @@
+#ifndef SIMPLIFIER_H
+#define SIMPLIFIER_H
+
+#include <vector>
+#include "utils/sceneparser.h"
+
+// Quadric error metric edge collapse over a fixed vertex buffer
+namespace Simplifier
+{
+    // Collapse edges until at most targetCount indexes remain or the next collapse would move the
+    // surface further than maxError, seam and border vertices never move
+    std::vector<unsigned int> simplify(const std::vector<Vertex>& vertices,
+                                       const std::vector<unsigned int>& indexes,
+                                       size_t targetCount,
+                                       float maxError);
+
+    // Coarser index lists over the same vertices, roughly halving triangles per level
+    // excludes the full resolution level, stops early once collapses stop paying off
+    std::vector<std::vector<unsigned int>> buildLods(const std::vector<Vertex>& vertices,
+                                                     const std::vector<unsigned int>& indexes,
+                                                     int numLevels);
+}
+
+#endif // SIMPLIFIER_H
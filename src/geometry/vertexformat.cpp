@@ -0,0 +1,32 @@
+#include "vertexformat.h"
+#include <glm/gtc/packing.hpp>
+
+namespace VertexFormat
+{
+    PackedVertex pack(const glm::vec3& pos,
+                      const glm::vec3& norm,
+                      const glm::vec2& uv,
+                      const glm::vec3& tang,
+                      const glm::vec3& bitang)
+    {
+        glm::vec3 N = glm::normalize(norm);
+
+        // orthogonalize tangent against normal so bitangent can be rebuilt from a cross product
+        glm::vec3 T = tang - N * glm::dot(N, tang);
+        if (glm::dot(T, T) < 1e-12f) {
+            T = glm::abs(N.x) < 0.9f ? glm::vec3{1.f, 0.f, 0.f} : glm::vec3{0.f, 1.f, 0.f};
+            T -= N * glm::dot(N, T);
+        }
+        T = glm::normalize(T);
+
+        // store handedness of tangent frame in w
+        float sign = glm::dot(glm::cross(N, T), bitang) < 0.f ? -1.f : 1.f;
+
+        return PackedVertex{
+            pos,
+            glm::packSnorm3x10_1x2(glm::vec4{N, 0.f}),
+            glm::packHalf2x16(uv),
+            glm::packSnorm3x10_1x2(glm::vec4{T, sign})
+        };
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "utils/sceneparser.h"
+
+// Compact GPU vertex layouts, decoded by default.vert
+namespace VertexFormat
+{
+    // Shared by every vertex (24 bytes)
+    struct PackedVertex {
+        glm::vec3 pos; // location 0, fp32
+        uint32_t norm; // location 1, snorm 10:10:10:2
+        uint32_t uv;   // location 2, 2 x half float
+        uint32_t tang; // location 3, snorm 10:10:10:2, w = bitangent sign
+    };
+
+    // Separate stream only allocated for skinned meshes
+    template <typename T>
+    struct SkinVertex {
+        T boneIDs[MAX_WEIGHTS];          // location 5, uint8 or uint16
+        uint8_t weights[MAX_WEIGHTS];    // location 6, unorm8
+    };
+
+    static_assert(sizeof(PackedVertex) == 24, "Packed vertex must stay tightly packed");
+
+    PackedVertex pack(const glm::vec3& pos,
+                      const glm::vec3& norm,
+                      const glm::vec2& uv,
+                      const glm::vec3& tang,
+                      const glm::vec3& bitang);
+
+    template <typename T>
+    SkinVertex<T> packSkin(const Vertex& vertex) {
+        SkinVertex<T> skin{};
+
+        for (int i = 0; i < MAX_WEIGHTS; ++i) {
+            // unused slots keep bone 0 with zero weight
+            if (vertex.boneIDs[i] < 0 || vertex.weights[i] <= 0.f) continue;
+
+            skin.boneIDs[i] = static_cast<T>(vertex.boneIDs[i]);
+            skin.weights[i] = static_cast<uint8_t>(glm::round(glm::clamp(vertex.weights[i], 0.f, 1.f) * 255.f));
+        }
+
+        return skin;
+    }
+}
+
+#endif // VERTEXFORMAT_H
@@ -0,0 +1,94 @@
+#include "offscreen.h"
+
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QSurfaceFormat>
+#include <iostream>
+#include "settings.h"
+#include "utils/profiler.h"
+
+int main(int argc, char *argv[]) {
+    // No display to attach to, fall back to the offscreen platform unless one was picked explicitly
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM") &&
+        qEnvironmentVariableIsEmpty("DISPLAY") &&
+        qEnvironmentVariableIsEmpty("WAYLAND_DISPLAY")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication a(argc, argv);
+
+    QCoreApplication::setApplicationName("Temporanim");
+    QCoreApplication::setOrganizationName("CS 1230");
+    QCoreApplication::setApplicationVersion(QT_VERSION_STR);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders a scene without a window and reports per-frame timing.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("scene", "Scene file to render.");
+    parser.addOptions({
+        {{"o", "output"}, "Write frames to <path>, a .y4m video or PNGs numbered after its name.", "path"},
+        {{"n", "frames"}, "Number of frames to render.", "count", "60"},
+        {"dt", "Fixed time step between frames in seconds.", "seconds", "0.016667"},
+        {"width", "Framebuffer width in pixels.", "pixels", "800"},
+        {"height", "Framebuffer height in pixels.", "pixels", "600"},
+        {"camera-path", "Move the camera along the keyframes in <file>.", "file"},
+        {"trace", "Write a Chrome trace of the CPU zones to <file>.", "file"},
+        {"near", "Near plane distance.", "distance", "0.1"},
+        {"far", "Far plane distance.", "distance", "100"},
+        {"param1", "Tessellation parameter 1.", "value", "1"},
+        {"param2", "Tessellation parameter 2.", "value", "1"},
+        {"gravity", "Enable gravity."},
+        {"rotation", "Enable rotation."},
+        {"collisions", "Enable collisions."},
+        {"play", "Toggle animation playback before the first frame."}
+    });
+    parser.process(a);
+
+    if (parser.positionalArguments().size() != 1) parser.showHelp(EXIT_FAILURE);
+
+    // Scene creation reads the same global settings the window does
+    settings.sceneFilePath = parser.positionalArguments()[0].toStdString();
+    settings.nearPlane = parser.value("near").toFloat();
+    settings.farPlane = parser.value("far").toFloat();
+    settings.shapeParameter1 = parser.value("param1").toInt();
+    settings.shapeParameter2 = parser.value("param2").toInt();
+    settings.enableGravity = parser.isSet("gravity");
+    settings.enableRotation = parser.isSet("rotation");
+    settings.enableCollisions = parser.isSet("collisions");
+
+    int frames = parser.value("frames").toInt();
+    float dt = parser.value("dt").toFloat();
+    int width = parser.value("width").toInt();
+    int height = parser.value("height").toInt();
+
+    if (frames < 0 || dt < 0.f || width <= 0 || height <= 0) {
+        std::cerr << "Frames and dt must not be negative, size must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    QSurfaceFormat fmt;
+    fmt.setVersion(4, 1);
+    fmt.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(fmt);
+
+    try {
+        CameraPath path;
+        if (parser.isSet("camera-path")) path = CameraPath{parser.value("camera-path").toStdString()};
+
+        Offscreen offscreen(width, height);
+        if (parser.isSet("play")) offscreen.playAnim();
+
+        offscreen.run(frames, dt, path, parser.value("output").toStdString());
+
+        if (parser.isSet("trace") && !Profiler::writeTrace(parser.value("trace").toStdString())) {
+            std::cerr << "Failed to write trace, is the profiler compiled in?" << std::endl;
+        }
+
+        Profiler::printSummary(std::cout);
+    } catch (std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,5 +1,6 @@
 #include "mainwindow.h"
 #include "settings.h"
+#include "utils/stats.h"
 
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -7,6 +8,8 @@
 #include <QSettings>
 #include <QLabel>
 #include <QGroupBox>
+#include <QFontDatabase>
+#include <algorithm>
 #include <iostream>
 
 void MainWindow::initialize() {
@@ -39,6 +42,9 @@ void MainWindow::initialize() {
     QLabel *ec_label = new QLabel(); // Extra Credit label
     ec_label->setText("Extra Credit");
     ec_label->setFont(font);
+    QLabel *stats_label = new QLabel(); // Stats label
+    stats_label->setText("Statistics");
+    stats_label->setFont(font);
     QLabel *param1_label = new QLabel(); // Parameter 1 label
     param1_label->setText("Parameter 1:");
     QLabel *param2_label = new QLabel(); // Parameter 2 label
@@ -66,6 +72,9 @@ void MainWindow::initialize() {
     saveImage = new QPushButton();
     saveImage->setText(QStringLiteral("Save Image"));
 
+    recordFrames = new QPushButton();
+    recordFrames->setText(QStringLiteral("Record Frames"));
+
     // Creates the boxes containing the parameter sliders and number boxes
     QGroupBox *p1Layout = new QGroupBox(); // horizonal slider 1 alignment
     QHBoxLayout *l1 = new QHBoxLayout();
@@ -163,8 +172,15 @@ void MainWindow::initialize() {
     ec4->setText(QStringLiteral("Enable Projectiles"));
     ec4->setChecked(false);
 
+    // Stats panel
+    frameGraph = new FrameGraph();
+    statsLabel = new QLabel();
+    statsLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    statsTimer = new QTimer(this);
+
     vLayout->addWidget(uploadFile);
     vLayout->addWidget(saveImage);
+    vLayout->addWidget(recordFrames);
     vLayout->addWidget(tessellation_label);
     vLayout->addWidget(param1_label);
     vLayout->addWidget(p1Layout);
@@ -188,6 +204,11 @@ void MainWindow::initialize() {
     vLayout->addWidget(ec3);
     vLayout->addWidget(ec4);
 
+    // Stats:
+    vLayout->addWidget(stats_label);
+    vLayout->addWidget(frameGraph);
+    vLayout->addWidget(statsLabel);
+
     connectUIElements();
 
     // Set default values of 5 for tessellation parameters
@@ -210,11 +231,13 @@ void MainWindow::connectUIElements() {
     //connectKernelBasedFilter();
     connectUploadFile();
     connectSaveImage();
+    connectRecordFrames();
     connectParam1();
     connectParam2();
     connectNear();
     connectFar();
     connectExtraCredit();
+    connectStats();
 }
 
 
@@ -234,6 +257,10 @@ void MainWindow::connectSaveImage() {
     connect(saveImage, &QPushButton::clicked, this, &MainWindow::onSaveImage);
 }
 
+void MainWindow::connectRecordFrames() {
+    connect(recordFrames, &QPushButton::clicked, this, &MainWindow::onRecordFrames);
+}
+
 void MainWindow::connectParam1() {
     connect(p1Slider, &QSlider::valueChanged, this, &MainWindow::onValChangeP1);
     connect(p1Box, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
@@ -268,6 +295,13 @@ void MainWindow::connectExtraCredit() {
     connect(realtime, &Realtime::sceneLoaded, this, &MainWindow::onSceneLoaded);
 }
 
+void MainWindow::connectStats() {
+    // Every presented frame feeds the graph, the text only changes on the timer
+    connect(realtime, &QOpenGLWidget::frameSwapped, this, &MainWindow::onFrameSwapped);
+    connect(statsTimer, &QTimer::timeout, this, &MainWindow::onRefreshStats);
+    statsTimer->start(STATS_REFRESH_MS);
+}
+
 // From old Project 6
 // void MainWindow::onPerPixelFilter() {
 //     settings.perPixelFilter = !settings.perPixelFilter;
@@ -315,6 +349,37 @@ void MainWindow::onSaveImage() {
     realtime->saveViewportImage(filePath.toStdString());
 }
 
+void MainWindow::onRecordFrames() {
+    // Second click ends the running capture
+    if (realtime->isCapturing()) {
+        realtime->stopCapture();
+        recordFrames->setText(QStringLiteral("Record Frames"));
+        return;
+    }
+
+    if (settings.sceneFilePath.empty()) {
+        std::cout << "No scene file loaded." << std::endl;
+        return;
+    }
+    std::string sceneName = settings.sceneFilePath.substr(0, settings.sceneFilePath.find_last_of("."));
+    sceneName = sceneName.substr(sceneName.find_last_of("/")+1);
+    QString selectedFilter;
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Record Frames"),
+                                                    QDir::currentPath()
+                                                        .append(QDir::separator())
+                                                        .append("outputs")
+                                                        .append(QDir::separator())
+                                                        .append(sceneName), tr("PNG Sequence (*.png);;Y4M Video (*.y4m)"),
+                                                    &selectedFilter);
+    if (filePath.isEmpty()) return;
+
+    // Format follows the extension, so add the one of the chosen filter if it was left out
+    if (selectedFilter.startsWith("Y4M") && !filePath.endsWith(".y4m")) filePath.append(".y4m");
+
+    realtime->startCapture(filePath.toStdString());
+    if (realtime->isCapturing()) recordFrames->setText(QStringLiteral("Stop Recording"));
+}
+
 void MainWindow::onValChangeP1(int newValue) {
     p1Slider->setValue(newValue);
     p1Box->setValue(newValue);
@@ -393,3 +458,58 @@ void MainWindow::onSceneLoaded() {
 
     realtime->settingsChanged();
 }
+
+// Stats:
+
+void MainWindow::onFrameSwapped() {
+    if (!frameTimer.isValid()) {
+        frameTimer.start();
+        return;
+    }
+
+    float ms = frameTimer.nsecsElapsed() / 1e6f;
+    frameTimer.restart();
+
+    frameGraph->addFrame(ms);
+
+    statsFrames++;
+    statsFrameMs += ms;
+    statsMaxMs = std::max(statsMaxMs, ms);
+}
+
+void MainWindow::onRefreshStats() {
+    float fps = statsFrameMs > 0.f ? statsFrames * 1000.f / statsFrameMs : 0.f;
+    float avgMs = statsFrames > 0 ? statsFrameMs / statsFrames : 0.f;
+
+    // Scene counters describe the latest frame and tick, the max shows spikes between refreshes
+    statsLabel->setText(QString::asprintf("FPS:             %.1f\n"
+                                          "Frame:           %.2f ms avg, %.2f ms max\n"
+                                          "Draw calls:      %d\n"
+                                          "Triangles:       %d\n"
+                                          "Occluded:        %d\n"
+                                          "Texture binds:   %d\n"
+                                          "State changes:   %d (%d saved)\n"
+                                          "Uniform uploads: %d\n"
+                                          "Uploaded:        %.1f KB\n"
+                                          "Rigid bodies:    %d\n"
+                                          "Collision tests: %d\n"
+                                          "Contacts:        %d\n"
+                                          "Animators:       %.3f ms",
+                                          fps, avgMs, statsMaxMs,
+                                          stats.drawCalls,
+                                          stats.triangles,
+                                          stats.occludedShapes,
+                                          stats.textureBinds,
+                                          stats.stateChanges, stats.stateChangesSaved,
+                                          stats.uniformUploads,
+                                          stats.bytesUploaded / 1024.f,
+                                          stats.rigidBodies,
+                                          stats.collisionTests,
+                                          stats.contacts,
+                                          stats.animatorMs));
+    frameGraph->update();
+
+    statsFrames = 0;
+    statsFrameMs = 0.f;
+    statsMaxMs = 0.f;
+}
@@ -6,7 +6,11 @@
 #include <QSpinBox>
 #include <QDoubleSpinBox>
 #include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "realtime.h"
+#include "utils/framegraph.h"
 #include "utils/aspectratiowidget/aspectratiowidget.hpp"
 
 class MainWindow : public QWidget
@@ -30,7 +34,9 @@ private:
 
     void connectUploadFile();
     void connectSaveImage();
+    void connectRecordFrames();
     void connectExtraCredit();
+    void connectStats();
 
     Realtime *realtime;
     AspectRatioWidget *aspectRatioWidget;
@@ -41,6 +47,7 @@ private:
 
     QPushButton *uploadFile;
     QPushButton *saveImage;
+    QPushButton *recordFrames;
     QSlider *p1Slider;
     QSlider *p2Slider;
     QSpinBox *p1Box;
@@ -56,6 +63,16 @@ private:
     QCheckBox *ec3;
     QCheckBox *ec4;
 
+    // Stats panel, refreshed a few times per second from the global stats
+    static constexpr int STATS_REFRESH_MS = 250;
+    QLabel *statsLabel;
+    FrameGraph *frameGraph;
+    QTimer *statsTimer;
+    QElapsedTimer frameTimer;   // time since the previous frame was swapped
+    int statsFrames = 0;        // frames swapped since the last refresh
+    float statsFrameMs = 0.f;   // summed over those frames
+    float statsMaxMs = 0.f;     // slowest of those frames
+
 private slots:
     // From old Project 6
     // void onPerPixelFilter();
@@ -63,6 +80,7 @@ private slots:
 
     void onUploadFile();
     void onSaveImage();
+    void onRecordFrames();
     void onValChangeP1(int newValue);
     void onValChangeP2(int newValue);
     void onValChangeNearSlider(int newValue);
@@ -78,4 +96,8 @@ private slots:
 
     // Reset extra credit checkboxes
     void onSceneLoaded();
+
+    // Stats panel
+    void onFrameSwapped();
+    void onRefreshStats();
 };
@@ -0,0 +1,208 @@
+#include "offscreen.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "settings.h"
+#include "buffer/readbackbuffer.h"
+#include "utils/framewriter.h"
+#include "utils/debug.h"
+#include "utils/gpuprofiler.h"
+#include "utils/stats.h"
+
+using namespace Debug;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    float millisSince(Clock::time_point start) {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    }
+
+    // value below which the given fraction of sorted samples falls
+    float percentile(const std::vector<float>& sorted, float fraction) {
+        return sorted[static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5f)];
+    }
+}
+
+Offscreen::Offscreen(int width, int height) {
+    PROFILE_THREAD("Render");
+
+    // Surface and context take the default format set in main
+    m_surface.create();
+    if (!m_surface.isValid()) throw std::runtime_error("Failed to create offscreen surface");
+
+    if (!m_context.create()) throw std::runtime_error("Failed to create OpenGL context");
+    if (!m_context.makeCurrent(&m_surface)) throw std::runtime_error("Failed to make OpenGL context current");
+
+    initializeGL();
+
+    // Draws go to a persistent framebuffer, the surface itself may not even be renderable
+    m_framebuffer = Framebuffer{width, height};
+
+    loadScene();
+}
+
+Offscreen::~Offscreen() {
+    m_context.makeCurrent(&m_surface);
+
+    // Delete VBOs and VAOs if scene exists
+    if (m_scene.has_value()) m_scene->clean();
+
+    // Delete shader programs, framebuffer and timer queries
+    m_shaders.clean();
+    m_framebuffer.clean();
+    GpuProfiler::clean();
+
+    m_context.doneCurrent();
+}
+
+void Offscreen::initializeGL() {
+    // GLEW reports a missing GLX display on EGL-only platforms after core functions already loaded,
+    // so like the windowed path a failure is reported but not fatal
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+    if (err != GLEW_OK) {
+        std::cerr << "Error while initializing GL: " << glewGetErrorString(err) << std::endl;
+    }
+    std::cout << "Initialized GL: " << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+
+    // Allows OpenGL to draw objects appropriately on top of one another
+    glEnable(GL_DEPTH_TEST);
+    // Tells OpenGL to only draw the front face
+    glEnable(GL_CULL_FACE);
+
+    // Variants compile on demand, the featureless one up front so shader errors surface at startup
+    m_shaders = ShaderVariants{":/resources/shaders/default.vert", ":/resources/shaders/default.frag"};
+    m_shaders.get(0);
+}
+
+void Offscreen::loadScene() {
+    auto start = Clock::now();
+
+    m_metaData = RenderData{};
+
+    // Parse render data
+    if (!SceneParser::parse(settings.sceneFilePath, m_metaData.value())) {
+        throw std::runtime_error("Error loading scene: \"" + settings.sceneFilePath + "\"");
+    }
+
+    // Create scene
+    m_scene = Scene(m_metaData.value(),
+                    m_framebuffer.getWidth() * 1.f / m_framebuffer.getHeight(),
+                    settings.nearPlane,
+                    settings.farPlane,
+                    settings.shapeParameter1,
+                    settings.shapeParameter2);
+
+    m_scene->enableGravity(settings.enableGravity);
+    m_scene->enableRotation(settings.enableRotation);
+    m_scene->enableCollisions(settings.enableCollisions);
+
+    // Compile every variant now so none lands inside a timed frame
+    m_scene->compileShaders(m_shaders);
+
+    // Upload every texture before frame 0, streamed in they would leave placeholders in a varying number of frames
+    m_scene->finishStreaming();
+
+    glErrorCheck();
+
+    std::cout << "Loaded scene in " << millisSince(start) << " ms, shader programs: "
+              << stats.programsCached << " cached, " << stats.programsCompiled << " compiled" << std::endl;
+}
+
+void Offscreen::run(int frames, float dt, const CameraPath& path, const std::string& outputPath) {
+    std::optional<FrameWriter> writer;
+    ReadbackBuffer readback;
+
+    if (!outputPath.empty()) {
+        QString outputDir = QFileInfo(QString::fromStdString(outputPath)).absolutePath();
+        if (!QDir().mkpath(outputDir)) throw std::runtime_error("Failed to create output directory: " + outputDir.toStdString());
+
+        // Offline capture waits on the encoders rather than drop frames
+        int fps = std::max(1, static_cast<int>(std::round(1.f / std::max(dt, 1e-3f))));
+        writer.emplace(outputPath, FrameWriter::getFormat(outputPath), fps, false);
+
+        readback = ReadbackBuffer{READBACK_BUFFERS, [&writer](const unsigned char* pixels, int width, int height) {
+            writer->write(pixels, width, height);
+        }};
+    }
+
+    std::vector<float> frameMs;
+
+    for (int i = 0; i < frames; ++i) {
+        PROFILE_FRAME();
+        GPU_FRAME();
+
+        auto start = Clock::now();
+
+        // Follow the path, otherwise stay at the scene camera
+        if (!path.empty()) {
+            CameraPath::Keyframe keyframe = path.sample(i * dt);
+            m_scene->moveCam(keyframe.pos, keyframe.look, keyframe.up);
+        }
+
+        m_scene->updateAnim(dt);
+        m_scene->updatePhys(dt);
+
+        float updateMs = millisSince(start);
+
+        m_framebuffer.bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // Scene binds the shader variant of each batch
+        m_scene->draw(m_shaders);
+        glUseProgram(0);
+
+        float drawMs = millisSince(start) - updateMs;
+
+        // Wait on the GPU so the frame time covers the whole frame, not just command submission
+        {
+            PROFILE_ZONE("Offscreen::waitGpu");
+            glFinish();
+        }
+        frameMs.push_back(millisSince(start));
+
+        glErrorCheck();
+
+        // Copy is queued after timing, encoding happens on the pool
+        if (writer) readback.read(m_framebuffer.getId(), m_framebuffer.getWidth(), m_framebuffer.getHeight());
+
+        std::cout << "Frame " << i << ": " << frameMs.back() << " ms (update " << updateMs
+                  << " ms, draw " << drawMs << " ms, gpu " << frameMs.back() - updateMs - drawMs << " ms), "
+                  << stats.stateChanges << " state changes (" << stats.stateChangesSaved << " saved by sorting), "
+                  << stats.occludedShapes << " occluded" << std::endl;
+    }
+
+    m_framebuffer.unbind();
+
+    // Close the last frame zone, GPU results of the final frames are ready after the wait above
+    PROFILE_FRAME();
+    GPU_FRAME();
+
+    if (writer) {
+        readback.collect(true);
+        readback.clean();
+        writer->finish();
+
+        std::cout << "Wrote " << stats.framesCaptured << " frames to " << outputPath << ", dropped "
+                  << stats.framesDropped << std::endl;
+    }
+
+    if (frameMs.empty()) return;
+
+    std::vector<float> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+
+    float totalMs = 0.f;
+    for (float ms : frameMs) totalMs += ms;
+
+    std::cout << frames << " frames at " << m_framebuffer.getWidth() << "x" << m_framebuffer.getHeight()
+              << ": mean " << totalMs / frames << " ms, min " << sorted.front() << " ms, p50 "
+              << percentile(sorted, 0.5f) << " ms, p95 " << percentile(sorted, 0.95f) << " ms, max "
+              << sorted.back() << " ms" << std::endl;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Defined before including GLEW to suppress deprecation messages on macOS
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include "buffer/framebuffer.h"
+#include "camera/camerapath.h"
+#include "scene/scene.h"
+
+// Renders the scene in the global settings without a window, for scripted captures and benchmarks
+class Offscreen
+{
+public:
+    // creates the context and loads the scene, throws if either fails
+    Offscreen(int width, int height);
+    ~Offscreen();
+
+    // toggle animation playback, as the P key does in the window
+    inline void playAnim() { m_scene->playAnim(); }
+
+    // step and draw frames at a fixed dt, following path if it has keyframes
+    // frames are written to outputPath unless it is empty, as a .y4m video or a PNG sequence named after it
+    void run(int frames, float dt, const CameraPath& path, const std::string& outputPath);
+
+private:
+    void initializeGL();
+    void loadScene();
+
+    // Context Related Variables
+    QOffscreenSurface m_surface;
+    QOpenGLContext m_context;
+    Framebuffer m_framebuffer;
+
+    // Capture Related Variables
+    static constexpr int READBACK_BUFFERS = 3;          // Frames a readback may trail rendering by before it waits
+
+    // Render and Scene Data
+    std::optional<RenderData> m_metaData;
+    std::optional<Scene> m_scene;
+
+    // Shader programs, one per feature combination in use
+    ShaderVariants m_shaders;
+};
@@ -10,6 +10,10 @@ struct Box {
     glm::vec3 side() const {
         return max - min;
     }
+
+    Box merge(const Box& that) const {
+        return Box{glm::min(min, that.min), glm::max(max, that.max)};
+    }
 };
 
 #endif // BOX_H
@@ -0,0 +1,324 @@
+#include "bvh.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Number of centroid bins evaluated per axis when splitting
+    constexpr int NUM_BINS = 12;
+
+    // Max boxes per leaf
+    constexpr int MAX_LEAF_SIZE = 4;
+
+    // Relative cost of traversing a node versus testing a box
+    constexpr float TRAVERSAL_COST = 1.f;
+
+    Box emptyBox() {
+        return Box{glm::vec3{std::numeric_limits<float>::max()}, glm::vec3{std::numeric_limits<float>::lowest()}};
+    }
+
+    float area(const Box& box) {
+        glm::vec3 side = glm::max(box.side(), glm::vec3{0.f});
+        return 2.f * (side.x * side.y + side.y * side.z + side.z * side.x);
+    }
+
+    bool overlaps(const Box& a, const Box& b) {
+        return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+    }
+
+    // slab test, returns entry distance if ray hits box within maxDist
+    std::optional<float> intersect(const Box& box, const glm::vec3& origin, const glm::vec3& invDir, float maxDist) {
+        glm::vec3 t0 = (box.min - origin) * invDir;
+        glm::vec3 t1 = (box.max - origin) * invDir;
+
+        // Axis-parallel rays have infinite reciprocals, an origin on a slab plane would give 0 * inf = NaN
+        // so such an axis is a plain containment test that leaves the interval open
+        for (int i = 0; i < 3; ++i) {
+            if (!std::isinf(invDir[i])) continue;
+            if (origin[i] < box.min[i] || origin[i] > box.max[i]) return std::nullopt;
+
+            t0[i] = std::numeric_limits<float>::lowest();
+            t1[i] = std::numeric_limits<float>::max();
+        }
+
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+
+        float enter = std::max({tNear.x, tNear.y, tNear.z, 0.f});
+        float exit = std::min({tFar.x, tFar.y, tFar.z, maxDist});
+
+        if (enter > exit) return std::nullopt;
+
+        return enter;
+    }
+}
+
+BVH::BVH(const std::vector<Box>& boxes, const std::vector<int>& ids) {
+    if (boxes.empty()) return;
+
+    m_boxes = boxes;
+    m_ids = ids;
+
+    std::vector<int> order(boxes.size());
+    for (int i = 0; i < order.size(); ++i) order[i] = i;
+
+    // at most 2n - 1 nodes
+    m_nodes.reserve(2 * boxes.size());
+    build(order, 0, order.size());
+
+    // reorder boxes and ids to match leaf ranges
+    for (int i = 0; i < order.size(); ++i) {
+        m_boxes[i] = boxes[order[i]];
+        m_ids[i] = ids[order[i]];
+    }
+}
+
+int BVH::build(std::vector<int>& order, int first, int count) {
+    int idx = m_nodes.size();
+    m_nodes.push_back(BVHNode{emptyBox(), first, count});
+
+    // bounds of boxes and of their centroids
+    Box bounds = emptyBox(), centroids = emptyBox();
+    for (int i = first; i < first + count; ++i) {
+        const Box& box = m_boxes[order[i]];
+        glm::vec3 c = (box.min + box.max) * 0.5f;
+
+        bounds = bounds.merge(box);
+        centroids = centroids.merge(Box{c, c});
+    }
+
+    m_nodes[idx].box = bounds;
+
+    if (count <= 1) return idx;
+
+    // find cheapest binned SAH split over all axes
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1, bestBin = -1;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        float lo = centroids.min[axis], hi = centroids.max[axis];
+        if (hi <= lo) continue;
+
+        std::array<Box, NUM_BINS> binBoxes;
+        std::array<int, NUM_BINS> binCounts{};
+        binBoxes.fill(emptyBox());
+
+        float scale = NUM_BINS / (hi - lo);
+        for (int i = first; i < first + count; ++i) {
+            const Box& box = m_boxes[order[i]];
+            float c = (box.min[axis] + box.max[axis]) * 0.5f;
+            int bin = std::min(static_cast<int>((c - lo) * scale), NUM_BINS - 1);
+
+            binBoxes[bin] = binBoxes[bin].merge(box);
+            binCounts[bin]++;
+        }
+
+        // sweep from right to get suffix areas, then from left to evaluate splits
+        std::array<float, NUM_BINS> rightArea{};
+        std::array<int, NUM_BINS> rightCount{};
+        Box acc = emptyBox();
+        int n = 0;
+        for (int b = NUM_BINS - 1; b > 0; --b) {
+            acc = acc.merge(binBoxes[b]);
+            n += binCounts[b];
+            rightArea[b] = area(acc);
+            rightCount[b] = n;
+        }
+
+        acc = emptyBox();
+        n = 0;
+        for (int b = 0; b < NUM_BINS - 1; ++b) {
+            acc = acc.merge(binBoxes[b]);
+            n += binCounts[b];
+
+            if (n == 0 || rightCount[b + 1] == 0) continue;
+
+            float cost = area(acc) * n + rightArea[b + 1] * rightCount[b + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    // keep as leaf if no split is found or splitting is not cheaper
+    float leafCost = area(bounds) * count;
+    float splitCost = TRAVERSAL_COST * area(bounds) + bestCost;
+
+    if (bestAxis < 0 || (count <= MAX_LEAF_SIZE && splitCost >= leafCost)) return idx;
+
+    // partition around chosen bin
+    float lo = centroids.min[bestAxis];
+    float scale = NUM_BINS / (centroids.max[bestAxis] - lo);
+
+    auto mid = std::partition(order.begin() + first, order.begin() + first + count, [&](int i) {
+        const Box& box = m_boxes[i];
+        float c = (box.min[bestAxis] + box.max[bestAxis]) * 0.5f;
+        return std::min(static_cast<int>((c - lo) * scale), NUM_BINS - 1) <= bestBin;
+    });
+
+    int leftCount = mid - (order.begin() + first);
+
+    // left child directly follows parent, right child index stored in parent
+    build(order, first, leftCount);
+    int right = build(order, first + leftCount, count - leftCount);
+
+    m_nodes[idx].offset = right;
+    m_nodes[idx].count = 0;
+
+    return idx;
+}
+
+void BVH::collectLeaves(int node, std::vector<int>& out) const {
+    // subtree boxes are contiguous in leaf order, find range via leftmost and rightmost leaves
+    int lo = node, hi = node;
+    while (m_nodes[lo].count == 0) lo = lo + 1;
+    while (m_nodes[hi].count == 0) hi = m_nodes[hi].offset;
+
+    for (int i = m_nodes[lo].offset; i < m_nodes[hi].offset + m_nodes[hi].count; ++i) out.push_back(m_ids[i]);
+}
+
+void BVH::queryFrustum(const Frustum& frustum, std::vector<int>& out) const {
+    if (m_nodes.empty()) return;
+
+    std::vector<int> stack{0};
+
+    while (!stack.empty()) {
+        int idx = stack.back();
+        stack.pop_back();
+
+        const BVHNode& node = m_nodes[idx];
+
+        glm::vec3 center = (node.box.min + node.box.max) * 0.5f;
+        glm::vec3 extent = (node.box.max - node.box.min) * 0.5f;
+
+        Containment result = frustum.classify(center, extent);
+
+        if (result == Containment::CONTAINMENT_OUTSIDE) continue;
+
+        // whole subtree visible, skip further plane tests
+        if (result == Containment::CONTAINMENT_INSIDE) {
+            collectLeaves(idx, out);
+            continue;
+        }
+
+        if (node.count > 0) {
+            for (int i = node.offset; i < node.offset + node.count; ++i) {
+                const Box& box = m_boxes[i];
+                if (frustum.classify((box.min + box.max) * 0.5f, (box.max - box.min) * 0.5f) != Containment::CONTAINMENT_OUTSIDE) {
+                    out.push_back(m_ids[i]);
+                }
+            }
+        } else {
+            stack.push_back(idx + 1);
+            stack.push_back(node.offset);
+        }
+    }
+}
+
+void BVH::queryBox(const Box& box, std::vector<int>& out) const {
+    if (m_nodes.empty()) return;
+
+    std::vector<int> stack{0};
+
+    while (!stack.empty()) {
+        int idx = stack.back();
+        stack.pop_back();
+
+        const BVHNode& node = m_nodes[idx];
+
+        if (!overlaps(node.box, box)) continue;
+
+        if (node.count > 0) {
+            for (int i = node.offset; i < node.offset + node.count; ++i) {
+                if (overlaps(m_boxes[i], box)) out.push_back(m_ids[i]);
+            }
+        } else {
+            stack.push_back(idx + 1);
+            stack.push_back(node.offset);
+        }
+    }
+}
+
+std::optional<RayHit> BVH::castRay(const glm::vec3& origin, const glm::vec3& dir, float maxDist) const {
+    if (m_nodes.empty()) return std::nullopt;
+
+    glm::vec3 invDir = 1.f / dir;
+    std::optional<RayHit> closest;
+
+    std::vector<int> stack{0};
+
+    while (!stack.empty()) {
+        int idx = stack.back();
+        stack.pop_back();
+
+        const BVHNode& node = m_nodes[idx];
+
+        // prune nodes beyond closest hit so far
+        if (!intersect(node.box, origin, invDir, maxDist)) continue;
+
+        if (node.count > 0) {
+            for (int i = node.offset; i < node.offset + node.count; ++i) {
+                auto t = intersect(m_boxes[i], origin, invDir, maxDist);
+                if (t) {
+                    closest = RayHit{m_ids[i], *t};
+                    maxDist = *t;
+                }
+            }
+        } else {
+            // visit nearer child first
+            auto tLeft = intersect(m_nodes[idx + 1].box, origin, invDir, maxDist);
+            auto tRight = intersect(m_nodes[node.offset].box, origin, invDir, maxDist);
+
+            if (tLeft && tRight) {
+                bool leftFirst = *tLeft <= *tRight;
+                stack.push_back(leftFirst ? node.offset : idx + 1);
+                stack.push_back(leftFirst ? idx + 1 : node.offset);
+            } else if (tLeft) {
+                stack.push_back(idx + 1);
+            } else if (tRight) {
+                stack.push_back(node.offset);
+            }
+        }
+    }
+
+    return closest;
+}
+
+void BVH::castRayAll(const glm::vec3& origin, const glm::vec3& dir, std::vector<RayHit>& out, float maxDist) const {
+    if (m_nodes.empty()) return;
+
+    glm::vec3 invDir = 1.f / dir;
+    size_t start = out.size();
+
+    std::vector<int> stack{0};
+
+    while (!stack.empty()) {
+        int idx = stack.back();
+        stack.pop_back();
+
+        const BVHNode& node = m_nodes[idx];
+
+        if (!intersect(node.box, origin, invDir, maxDist)) continue;
+
+        if (node.count > 0) {
+            for (int i = node.offset; i < node.offset + node.count; ++i) {
+                auto t = intersect(m_boxes[i], origin, invDir, maxDist);
+                if (t) out.push_back(RayHit{m_ids[i], *t});
+            }
+        } else {
+            stack.push_back(idx + 1);
+            stack.push_back(node.offset);
+        }
+    }
+
+    // order new hits front to back
+    std::sort(out.begin() + start, out.end(), [](const RayHit& a, const RayHit& b) { return a.t < b.t; });
+}
+
+bool BVH::empty() const {
+    return m_nodes.empty();
+}
@@ -0,0 +1,52 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <limits>
+#include <optional>
+#include <vector>
+#include "box.h"
+#include "camera/frustum.h"
+
+struct RayHit {
+    int id;  // id of hit box
+    float t; // distance along ray direction
+};
+
+// Node of flattened tree, left child directly follows its parent
+struct BVHNode {
+    Box box;
+    int offset; // right child index if interior, first box if leaf
+    int count;  // number of boxes in leaf, 0 if interior
+};
+
+class BVH
+{
+public:
+    BVH() {}
+
+    // builds over world space boxes, queries report the matching entry of ids
+    BVH(const std::vector<Box>& boxes, const std::vector<int>& ids);
+
+    void queryFrustum(const Frustum& frustum, std::vector<int>& out) const;
+
+    void queryBox(const Box& box, std::vector<int>& out) const;
+
+    std::optional<RayHit> castRay(const glm::vec3& origin, const glm::vec3& dir,
+                                  float maxDist = std::numeric_limits<float>::max()) const;
+
+    void castRayAll(const glm::vec3& origin, const glm::vec3& dir, std::vector<RayHit>& out,
+                    float maxDist = std::numeric_limits<float>::max()) const;
+
+    bool empty() const;
+
+private:
+    std::vector<BVHNode> m_nodes;
+    std::vector<Box> m_boxes; // leaf order
+    std::vector<int> m_ids;   // leaf order
+
+    int build(std::vector<int>& order, int first, int count);
+
+    void collectLeaves(int node, std::vector<int>& out) const;
+};
+
+#endif // BVH_H
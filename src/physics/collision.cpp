@@ -37,6 +37,22 @@ const Box& Collision::getBox() const {
     return box;
 }
 
+Box Collision::getObjectBox() const {
+    // primitives fit in unit cube centered at origin
+    if (type != PrimitiveType::PRIMITIVE_MESH) return Box{glm::vec3{-0.5f}, glm::vec3{0.5f}};
+
+    return Box{min, max};
+}
+
+Box Collision::getCollisionBox() const {
+    if (type == PrimitiveType::PRIMITIVE_MESH) return box;
+
+    // NOTE: cubes are treated as axis-aligned, see cubeBox
+    if (type == PrimitiveType::PRIMITIVE_CUBE) return Box{center - height * 0.5f, center + height * 0.5f};
+
+    return Box{center, center};
+}
+
 void Collision::scaleBox(float factor) {
     glm::vec3 center = (box.max + box.min) * 0.5f;
     glm::vec3 extents = (box.max - box.min) * 0.5f * factor;
@@ -19,6 +19,11 @@ public:
 
     const Box& getBox() const;
 
+    Box getObjectBox() const;
+
+    // world space box used by detect, degenerate for shapes detect ignores
+    Box getCollisionBox() const;
+
     void updateBox(const glm::mat4& ctm);
 
     std::optional<Contact> detect(const Collision& that) const;
@@ -4,6 +4,7 @@ void Cube::updateParams(int param1, int param2) {
     m_vertexData.clear();
     m_param1 = param1;
     setVertexData();
+    weld();
 }
 
 void Cube::makeFace(const glm::vec3& topLeft,
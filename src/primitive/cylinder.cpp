@@ -5,6 +5,7 @@ void Cylinder::updateParams(int param1, int param2) {
     m_param1 = param1;
     m_param2 = std::max(param2, 3);
     setVertexData();
+    weld();
 }
 
 glm::vec2 Cylinder::calcUV(const glm::vec3& pt) {
@@ -1,4 +1,21 @@
 #include "primitive.h"
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+    // Quantized position, normal and uv of a vertex
+    using WeldKey = std::array<int, 8>;
+
+    struct WeldKeyHash {
+        size_t operator()(const WeldKey& key) const {
+            size_t hash = 0;
+            for (int k : key) hash = hash * 31 + std::hash<int>{}(k);
+            return hash;
+        }
+    };
+}
 
 void Primitive::init(int param1, int param2) {
     m_param1 = param1;
@@ -6,8 +23,42 @@ void Primitive::init(int param1, int param2) {
     updateParams(param1, param2);
 }
 
-const std::vector<float>& Primitive::generateShape() {
-    return m_vertexData;
+const Tessellation& Primitive::generateShape() const {
+    return m_tess;
+}
+
+void Primitive::weld() {
+    std::unordered_map<WeldKey, unsigned int, WeldKeyHash> vertexMap;
+
+    std::vector<float>& welded = m_tess.vertexData;
+    std::vector<unsigned int>& indexes = m_tess.indexes;
+
+    welded.clear();
+    indexes.clear();
+
+    for (size_t v = 0; v < m_vertexData.size(); v += STRIDE) {
+        const float* vertex = &m_vertexData[v];
+
+        // quantize position, normal and uv so near-equal floats weld
+        WeldKey key;
+        for (int i = 0; i < 8; ++i) key[i] = static_cast<int>(std::lround(vertex[i] / EPS));
+
+        auto [it, inserted] = vertexMap.try_emplace(key, welded.size() / STRIDE);
+
+        if (inserted) {
+            welded.insert(welded.end(), vertex, vertex + STRIDE);
+        } else {
+            // accumulate per-triangle tangent and bitangent, shader normalizes them
+            float* weldedVertex = &welded[it->second * STRIDE];
+            for (int i = 8; i < STRIDE; ++i) weldedVertex[i] += vertex[i];
+        }
+
+        indexes.push_back(it->second);
+    }
+
+    // soup is only scratch for welding
+    m_vertexData.clear();
+    m_vertexData.shrink_to_fit();
 }
 
 glm::vec2 Primitive::calcPlaneUV(const glm::vec3& pt,
@@ -4,10 +4,16 @@
 #include <vector>
 #include <glm/glm.hpp>
 
+// Indexed vertex data of one tessellation, 14 floats per vertex
+struct Tessellation {
+    std::vector<float> vertexData;
+    std::vector<unsigned int> indexes;
+};
+
 class Primitive
 {
 public:
-    const std::vector<float>& generateShape();
+    const Tessellation& generateShape() const;
 
     virtual void updateParams(int param1, int param2) = 0;
 
@@ -15,7 +21,8 @@ public:
 
 protected:
     // member vars
-    std::vector<float> m_vertexData;
+    std::vector<float> m_vertexData; // triangle soup written by subclasses
+    Tessellation m_tess;             // welded vertices and indexes
 
     int m_param1;
     int m_param2;
@@ -23,11 +30,17 @@ protected:
 
     static constexpr float EPS = 1e-4f;
 
+    // 3 vert + 3 norm + 2 uv + 3 tang + 3 bitang
+    static constexpr int STRIDE = 14;
+
     // protected funcs
     virtual void setVertexData() = 0;
 
     void init(int param1, int param2);
 
+    // merge soup vertices sharing position, normal and uv into indexed data
+    void weld();
+
     glm::vec2 calcPlaneUV(const glm::vec3& pt,
                           const glm::vec3& n);
 
@@ -5,6 +5,7 @@ void Sphere::updateParams(int param1, int param2) {
     m_param1 = std::max(param1, 2);
     m_param2 = std::max(param2, 3);
     setVertexData();
+    weld();
 }
 
 glm::vec2 Sphere::calcUV(const glm::vec3& pt) {
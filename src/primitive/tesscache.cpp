@@ -0,0 +1,58 @@
+#include "tesscache.h"
+#include <memory>
+#include "cone.h"
+#include "cube.h"
+#include "cylinder.h"
+#include "sphere.h"
+#include "utils/profiler.h"
+#include "utils/threadpool.h"
+
+namespace
+{
+    Tessellation generate(PrimitiveType type, int param1, int param2) {
+        std::unique_ptr<Primitive> prim;
+
+        switch(type) {
+            case PrimitiveType::PRIMITIVE_CUBE:
+                prim = std::make_unique<Cube>(param1);
+                break;
+            case PrimitiveType::PRIMITIVE_CONE:
+                prim = std::make_unique<Cone>(param1, param2);
+                break;
+            case PrimitiveType::PRIMITIVE_CYLINDER:
+                prim = std::make_unique<Cylinder>(param1, param2);
+                break;
+            case PrimitiveType::PRIMITIVE_SPHERE:
+                prim = std::make_unique<Sphere>(param1, param2);
+                break;
+            default:
+                throw std::invalid_argument("Meshes cannot be tessellated");
+        }
+
+        return prim->generateShape();
+    }
+}
+
+std::shared_future<Tessellation> TessCache::request(PrimitiveType type, int param1, int param2) {
+    // cube ignores second param, share its entries
+    TessKey key{type, param1, type == PrimitiveType::PRIMITIVE_CUBE ? 0 : param2};
+
+    auto it = m_cache.find(key);
+    if (it != m_cache.end()) return it->second;
+
+    // evict oldest entry, pending users keep their own copy of the future
+    if (m_cache.size() >= MAX_ENTRIES) {
+        m_cache.erase(m_order.front());
+        m_order.pop_front();
+    }
+
+    std::shared_future<Tessellation> tess = ThreadPool::instance().submit([type, param1, param2]() {
+        PROFILE_ZONE("TessCache::generate");
+        return generate(type, param1, param2);
+    }).share();
+
+    m_cache.emplace(key, tess);
+    m_order.push_back(key);
+
+    return tess;
+}
@@ -0,0 +1,39 @@
+#ifndef TESSCACHE_H
+#define TESSCACHE_H
+
+#include <deque>
+#include <future>
+#include <unordered_map>
+#include "primitive.h"
+#include "utils/scenedata.h"
+
+// Identifies one tessellation of one primitive type
+struct TessKey {
+    PrimitiveType type;
+    int param1;
+    int param2;
+
+    bool operator==(const TessKey& that) const = default;
+};
+
+struct TessKeyHash {
+    size_t operator()(const TessKey& key) const {
+        return (static_cast<size_t>(key.type) * 31 + key.param1) * 31 + key.param2;
+    }
+};
+
+class TessCache
+{
+public:
+    // returns cached tessellation, or starts generating it on the worker pool
+    std::shared_future<Tessellation> request(PrimitiveType type, int param1, int param2);
+
+private:
+    // max number of cached tessellations before oldest are evicted
+    static constexpr int MAX_ENTRIES = 32;
+
+    std::unordered_map<TessKey, std::shared_future<Tessellation>, TessKeyHash> m_cache;
+    std::deque<TessKey> m_order; // insertion order for eviction
+};
+
+#endif // TESSCACHE_H
@@ -6,9 +6,10 @@
 #include <QDir>
 #include <iostream>
 #include "settings.h"
-#include "utils/shaderloader.h"
 #include "utils/transform.h"
 #include "utils/debug.h"
+#include "utils/gpuprofiler.h"
+#include "utils/stats.h"
 
 using namespace Debug;
 
@@ -38,22 +39,34 @@ Realtime::Realtime(QWidget *parent)
 
     // Throwing button
     m_keyMap[Qt::Key_F]       = false;
+
+    // Profile export button
+    m_keyMap[Qt::Key_T]       = false;
 }
 
 void Realtime::finish() {
     killTimer(m_timer);
+
+    // Write out frames still in flight
+    if (isCapturing()) stopCapture();
+
     this->makeCurrent();
 
     // Delete VBOs and VAOs if scene exists
     if (m_scene.has_value()) m_scene->clean();
 
-    // Delete shader program
-    glDeleteProgram(m_shader);
+    // Delete shader programs
+    m_shaders.clean();
+
+    // Delete timer queries
+    GpuProfiler::clean();
 
     this->doneCurrent();
 }
 
 void Realtime::initializeGL() {
+    PROFILE_THREAD("Render");
+
     m_devicePixelRatio = this->devicePixelRatio();
 
     m_timer = startTimer(1000/60);
@@ -75,14 +88,12 @@ void Realtime::initializeGL() {
     // Tells OpenGL how big the screen is
     glViewport(0, 0, size().width() * m_devicePixelRatio, size().height() * m_devicePixelRatio);
 
-    // Load shader program ID
-    m_shader = ShaderLoader::createShaderProgram(
-                    ":/resources/shaders/default.vert",
-                    ":/resources/shaders/default.frag"
-                );
-
     // Parse projectiles
     try {
+        // Variants compile on demand, the featureless one up front so shader errors surface at startup
+        m_shaders = ShaderVariants{":/resources/shaders/default.vert", ":/resources/shaders/default.frag"};
+        m_shaders.get(0);
+
         parseProjectiles();
     } catch (std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
@@ -91,23 +102,46 @@ void Realtime::initializeGL() {
 }
 
 void Realtime::paintGL() {
+    // Frames run from one paint to the next, so they include the tick in between
+    PROFILE_FRAME();
+    PROFILE_ZONE("Realtime::paintGL");
+
     if (!m_scene.has_value()) return;
 
+    // GPU timings of earlier frames are collected here, never waiting on ones still in flight
+    GPU_FRAME();
+    GPU_ZONE("Realtime::paintGL");
+
     // Clear screen
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Bind shader
-    glUseProgram(m_shader);
-
     glErrorCheck();
 
+    // Scene binds the shader variant of each batch
     try {
-        m_scene->draw(m_shader);
+        m_scene->draw(m_shaders);
     } catch (std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         finish();
     }
 
+    // Queue a copy of the frame, it is encoded once the GPU is done with it a few frames later
+    if (isCapturing()) {
+        m_readback.read(defaultFramebufferObject(),
+                        size().width() * m_devicePixelRatio,
+                        size().height() * m_devicePixelRatio);
+    }
+
+    // Log time to first frame once the GPU has actually finished it
+    if (m_firstFramePending) {
+        glFinish();
+        m_firstFramePending = false;
+
+        std::cout << "First frame after " << m_loadTimer.elapsed() << " ms, shader programs: "
+                  << stats.programsCached << " cached, " << stats.programsCompiled << " compiled in "
+                  << stats.programMs << " ms" << std::endl;
+    }
+
     glErrorCheck();
 
     // Unbind shader
@@ -125,6 +159,10 @@ void Realtime::resizeGL(int w, int h) {
 void Realtime::sceneChanged() {
     makeCurrent();
 
+    // Time to first frame covers parsing, uploads and shader variants
+    m_loadTimer.start();
+    m_firstFramePending = true;
+
     m_metaData = RenderData{};
 
     // Parse render data
@@ -148,9 +186,10 @@ void Realtime::sceneChanged() {
                     settings.shapeParameter1,
                     settings.shapeParameter2);
 
-    // Add projectile data to scene
+    // Add projectile data to scene, then compile the shader variants its shapes need
     try {
         m_scene->loadProjectiles(m_projectiles);
+        m_scene->compileShaders(m_shaders);
     } catch (std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         finish();
@@ -181,6 +220,49 @@ void Realtime::settingsChanged() {
     update(); // asks for a PaintGL() call to occur
 }
 
+void Realtime::startCapture(const std::string& filePath) {
+    if (isCapturing()) stopCapture();
+
+    makeCurrent();
+
+    try {
+        // Matches the ~60 Hz tick of the timer
+        m_capture.emplace(filePath, FrameWriter::getFormat(filePath), 60, true);
+    } catch (std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return;
+    }
+
+    m_readback = ReadbackBuffer{READBACK_BUFFERS, [this](const unsigned char* pixels, int width, int height) {
+        m_capture->write(pixels, width, height);
+    }};
+
+    stats.framesCaptured = 0;
+    stats.framesDropped = 0;
+    stats.captureStalls = 0;
+
+    std::cout << "Capturing frames to: \"" << filePath << "\"." << std::endl;
+}
+
+void Realtime::stopCapture() {
+    if (!isCapturing()) return;
+
+    makeCurrent();
+
+    // Flush the frames still on the GPU, then wait for the encoders
+    m_readback.collect(true);
+    m_readback.clean();
+    m_capture->finish();
+    m_capture.reset();
+
+    std::cout << "Captured " << stats.framesCaptured << " frames, dropped " << stats.framesDropped
+              << ", stalled on readback " << stats.captureStalls << " times" << std::endl;
+}
+
+bool Realtime::isCapturing() const {
+    return m_capture.has_value();
+}
+
 // ================== Auxiliary Functions!
 
 void Realtime::parseProjectiles() {
@@ -217,6 +299,8 @@ void Realtime::parseProjectiles() {
 }
 
 void Realtime::toggleFeatures() {
+    PROFILE_ZONE("Realtime::toggleFeatures");
+
     // Swap to previous animation if pressing left arrow, else to next if right arrow
     if (m_keyMap[Qt::Key_Left]) m_scene->swapAnim(false);
     else if (m_keyMap[Qt::Key_Right]) m_scene->swapAnim(true);
@@ -231,6 +315,11 @@ void Realtime::toggleFeatures() {
     // Save N's toggle state to avoid per-frame checks
     m_nToggled = m_keyMap[Qt::Key_N];
 
+    // Export CPU profile
+    if (m_keyMap[Qt::Key_T] && !m_tToggled) saveProfile();
+    // Save T's toggle state to avoid per-frame checks
+    m_tToggled = m_keyMap[Qt::Key_T];
+
     // Enable F key when projectiles are enabled
     if (settings.enableProjectiles) {
         try {
@@ -245,6 +334,25 @@ void Realtime::toggleFeatures() {
     }
 }
 
+void Realtime::saveProfile() {
+    // Get abs path of trace file
+    QString filePath = QDir::currentPath()
+                                 .append(QDir::separator())
+                                 .append("outputs")
+                                 .append(QDir::separator())
+                                 .append("profile.json");
+
+    std::string tracePath = filePath.toStdString();
+
+    if (!Profiler::writeTrace(tracePath)) {
+        std::cerr << "Failed to save profile to " << tracePath << ", is the profiler compiled in?" << std::endl;
+        return;
+    }
+
+    std::cout << "Saved Chrome trace to: \"" << tracePath << "\"." << std::endl;
+    Profiler::printSummary(std::cout);
+}
+
 // ================== Camera Movement!
 
 void Realtime::keyPressEvent(QKeyEvent *event) {
@@ -304,6 +412,8 @@ void Realtime::mouseMoveEvent(QMouseEvent *event) {
 }
 
 void Realtime::timerEvent(QTimerEvent *event) {
+    PROFILE_ZONE("Realtime::timerEvent");
+
     makeCurrent();
 
     if (!m_metaData.has_value() || !m_scene.has_value()) return;
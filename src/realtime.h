@@ -12,7 +12,9 @@
 #include <QOpenGLWidget>
 #include <QTime>
 #include <QTimer>
+#include "buffer/readbackbuffer.h"
 #include "scene/scene.h"
+#include "utils/framewriter.h"
 
 class Realtime : public QOpenGLWidget
 {
@@ -25,6 +27,11 @@ public:
     void settingsChanged();
     void saveViewportImage(std::string filePath);
 
+    // record every painted frame to filePath, a .y4m video or a PNG sequence named after it
+    void startCapture(const std::string& filePath);
+    void stopCapture();
+    bool isCapturing() const;
+
 signals:
     void sceneLoaded();                                 // Called when scene is loaded
 
@@ -44,10 +51,13 @@ private:
     void parseProjectiles();
 
     void toggleFeatures();
+    void saveProfile();
 
     // Tick Related Variables
     int m_timer;                                        // Stores timer which attempts to run ~60 times per second
     QElapsedTimer m_elapsedTimer;                       // Stores timer which keeps track of actual time between frames
+    QElapsedTimer m_loadTimer;                          // Stores timer from scene load to its first finished frame
+    bool m_firstFramePending = false;                   // Stores whether first frame of loaded scene is not yet drawn
 
     // Input Related Variables
     bool m_mouseDown = false;                           // Stores state of left mouse button
@@ -56,6 +66,7 @@ private:
     bool m_pToggled = false;                            // Stores state of P key
     bool m_nToggled = false;                            // Stores state of N key
     bool m_fToggled = false;                            // Stores state of F key
+    bool m_tToggled = false;                            // Stores state of T key
 
     // Device Correction Variables
     double m_devicePixelRatio;
@@ -64,9 +75,14 @@ private:
     std::optional<RenderData> m_metaData;
     std::optional<Scene> m_scene;
 
-    // Shader Program ID
-    GLuint m_shader;
+    // Shader programs, one per feature combination in use
+    ShaderVariants m_shaders;
 
     // Projectile Data
     Projectile m_projectiles;
+
+    // Capture Related Variables
+    static constexpr int READBACK_BUFFERS = 3;          // Frames a readback may trail rendering by before it waits
+    ReadbackBuffer m_readback;                          // Stores in-flight copies of painted frames
+    std::optional<FrameWriter> m_capture;               // Stores encoder of the running capture, if any
 };
@@ -0,0 +1,230 @@
+#include "lightgrid.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <thread>
+#include "utils/profiler.h"
+#include "utils/threadpool.h"
+
+namespace
+{
+    // below this many binned lights one thread bins faster than waking the pool
+    constexpr size_t PARALLEL_MIN_LIGHTS = 32;
+
+    // slices handed out on demand, shared with pool tasks that may start after the build returns
+    struct SliceQueue {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+    };
+}
+
+void LightGrid::setProjection(float widthAngle, float heightAngle, float near, float far) {
+    m_near = near;
+    m_far = far;
+
+    float tanX = glm::tan(widthAngle * 0.5f);
+    float tanY = glm::tan(heightAngle * 0.5f);
+
+    // Exponential slices keep clusters roughly cubic in view space
+    m_sliceDepths.resize(SLICES + 1);
+    for (int s = 0; s <= SLICES; ++s) m_sliceDepths[s] = near * glm::pow(far / near, s * 1.f / SLICES);
+
+    for (auto* bounds : {&m_minX, &m_minY, &m_minZ, &m_maxX, &m_maxY, &m_maxZ}) bounds->resize(NUM_CLUSTERS);
+
+    for (int s = 0; s < SLICES; ++s) {
+        float zNear = m_sliceDepths[s];
+        float zFar = m_sliceDepths[s + 1];
+
+        for (int y = 0; y < TILES_Y; ++y) {
+            float y0 = -1.f + 2.f * y / TILES_Y;
+            float y1 = -1.f + 2.f * (y + 1) / TILES_Y;
+
+            for (int x = 0; x < TILES_X; ++x) {
+                float x0 = -1.f + 2.f * x / TILES_X;
+                float x1 = -1.f + 2.f * (x + 1) / TILES_X;
+                int c = (s * TILES_Y + y) * TILES_X + x;
+
+                // Tile edges fan out from the eye, so the box spans both slice depths
+                m_minX[c] = std::min(x0 * zNear, x0 * zFar) * tanX;
+                m_maxX[c] = std::max(x1 * zNear, x1 * zFar) * tanX;
+                m_minY[c] = std::min(y0 * zNear, y0 * zFar) * tanY;
+                m_maxY[c] = std::max(y1 * zNear, y1 * zFar) * tanY;
+
+                // Camera looks down -z
+                m_minZ[c] = -zFar;
+                m_maxZ[c] = -zNear;
+            }
+        }
+    }
+}
+
+void LightGrid::build(const std::vector<SceneLightData>& lights, const glm::mat4& view) {
+    PROFILE_ZONE("LightGrid::build");
+
+    m_spheres.clear();
+    m_lightIds.clear();
+
+    for (int i = 0; i < lights.size(); ++i) {
+        const SceneLightData& light = lights[i];
+        if (light.type == LightType::LIGHT_DIRECTIONAL) continue;
+
+        // Lights too dim to ever show are dropped entirely
+        float range = getRange(light);
+        if (range <= 0.f) continue;
+
+        glm::vec4 sphere = getBoundingSphere(light, range);
+        m_spheres.push_back(glm::vec4{glm::vec3{view * glm::vec4{glm::vec3{sphere}, 1.f}}, sphere.w});
+        m_lightIds.push_back(i);
+    }
+
+    m_sliceIndexes.resize(SLICES);
+    m_sliceCounts.resize(SLICES);
+
+    // Render thread claims slices alongside the pool, so workers busy cooking textures never stall the frame
+    auto queue = std::make_shared<SliceQueue>();
+
+    auto binSlices = [this, queue]() {
+        for (int s = queue->next++; s < SLICES; s = queue->next++) {
+            binSlice(s);
+            queue->done++;
+        }
+    };
+
+    if (m_spheres.size() >= PARALLEL_MIN_LIGHTS) {
+        int helpers = std::min<int>(SLICES, std::max(1u, std::thread::hardware_concurrency()) - 1);
+        for (int i = 0; i < helpers; ++i) ThreadPool::instance().submit(binSlices);
+    }
+
+    binSlices();
+
+    // Only slices already claimed by a worker can still be in flight
+    while (queue->done < SLICES) std::this_thread::yield();
+
+    // Concatenate slices in cluster order
+    m_cells.resize(NUM_CLUSTERS);
+    m_indexes.clear();
+
+    for (int s = 0; s < SLICES; ++s) {
+        const std::vector<uint32_t>& counts = m_sliceCounts[s];
+
+        uint32_t offset = m_indexes.size();
+
+        // Each slice's lists are already in tile order
+        for (int t = 0; t < TILES_X * TILES_Y; ++t) {
+            m_cells[s * TILES_X * TILES_Y + t] = glm::uvec2{offset, counts[t]};
+            offset += counts[t];
+        }
+
+        m_indexes.insert(m_indexes.end(), m_sliceIndexes[s].begin(), m_sliceIndexes[s].end());
+    }
+}
+
+void LightGrid::binSlice(int slice) {
+    PROFILE_ZONE("LightGrid::binSlice");
+
+    float zNear = m_sliceDepths[slice];
+    float zFar = m_sliceDepths[slice + 1];
+
+    // Only lights whose depth range overlaps the slice are tested against its tiles
+    std::vector<int> candidates;
+    for (int k = 0; k < m_spheres.size(); ++k) {
+        float depth = -m_spheres[k].z;
+        if (depth - m_spheres[k].w < zFar && depth + m_spheres[k].w > zNear) candidates.push_back(k);
+    }
+
+    std::vector<uint32_t>& indexes = m_sliceIndexes[slice];
+    std::vector<uint32_t>& counts = m_sliceCounts[slice];
+    counts.assign(TILES_X * TILES_Y, 0);
+
+    // (tile, light) of every overlap, in light order
+    std::vector<glm::uvec2> hits;
+    int first = slice * TILES_X * TILES_Y;
+
+    for (int k : candidates) {
+        const glm::vec4& sphere = m_spheres[k];
+        float radius2 = sphere.w * sphere.w;
+
+        // Squared distance from sphere center to the closest point of a cluster box, per axis
+        auto distX = [&](int x) { return std::max({m_minX[first + x] - sphere.x, 0.f, sphere.x - m_maxX[first + x]}); };
+        auto distY = [&](int y) { return std::max({m_minY[first + y * TILES_X] - sphere.y, 0.f, sphere.y - m_maxY[first + y * TILES_X]}); };
+        float dz = std::max({m_minZ[first] - sphere.z, 0.f, sphere.z - m_maxZ[first]});
+
+        // Columns and rows share bounds across the slice, so narrow to the tiles each axis allows
+        int x0 = 0, x1 = TILES_X - 1, y0 = 0, y1 = TILES_Y - 1;
+        while (x0 <= x1 && distX(x0) * distX(x0) + dz * dz > radius2) x0++;
+        while (x1 >= x0 && distX(x1) * distX(x1) + dz * dz > radius2) x1--;
+        while (y0 <= y1 && distY(y0) * distY(y0) + dz * dz > radius2) y0++;
+        while (y1 >= y0 && distY(y1) * distY(y1) + dz * dz > radius2) y1--;
+
+        for (int y = y0; y <= y1; ++y) {
+            float dy = distY(y);
+
+            for (int x = x0; x <= x1; ++x) {
+                float dx = distX(x);
+                if (dx * dx + dy * dy + dz * dz > radius2) continue;
+
+                hits.push_back(glm::uvec2{y * TILES_X + x, m_lightIds[k]});
+                counts[y * TILES_X + x]++;
+            }
+        }
+    }
+
+    // Counting sort by tile, stable so each list stays in light order
+    std::vector<uint32_t> cursor(TILES_X * TILES_Y, 0);
+    for (int t = 1; t < TILES_X * TILES_Y; ++t) cursor[t] = cursor[t - 1] + counts[t - 1];
+
+    indexes.resize(hits.size());
+    for (const glm::uvec2& hit : hits) indexes[cursor[hit.x]++] = hit.y;
+}
+
+const std::vector<glm::uvec2>& LightGrid::getCells() const {
+    return m_cells;
+}
+
+const std::vector<uint32_t>& LightGrid::getIndexes() const {
+    return m_indexes;
+}
+
+float LightGrid::getSliceScale() const {
+    return SLICES / glm::log(m_far / m_near);
+}
+
+float LightGrid::getRange(const SceneLightData& light) {
+    float brightest = glm::max(light.color.r, glm::max(light.color.g, light.color.b));
+    if (brightest <= 0.f) return 0.f;
+
+    // Solve c0 + c1 d + c2 d^2 = brightest / MIN_ILLUMINANCE for d
+    float target = brightest / MIN_ILLUMINANCE;
+    const glm::vec3& c = light.function;
+
+    if (c.x >= target) return 0.f;
+
+    if (c.z > 0.f) return (-c.y + glm::sqrt(c.y * c.y + 4.f * c.z * (target - c.x))) / (2.f * c.z);
+    if (c.y > 0.f) return (target - c.x) / c.y;
+
+    // Unattenuated, reaches every cluster
+    return std::numeric_limits<float>::infinity();
+}
+
+int LightGrid::orderLights(std::vector<SceneLightData>& lights) {
+    auto dirEnd = std::stable_partition(lights.begin(), lights.end(), [](const SceneLightData& light) {
+        return light.type == LightType::LIGHT_DIRECTIONAL;
+    });
+
+    return dirEnd - lights.begin();
+}
+
+glm::vec4 LightGrid::getBoundingSphere(const SceneLightData& light, float range) {
+    glm::vec3 pos{light.pos};
+
+    if (light.type != LightType::LIGHT_SPOT || std::isinf(range)) return glm::vec4{pos, range};
+
+    // Narrow cones fit a smaller sphere through the apex and the rim of the cap
+    float cosAngle = glm::cos(light.angle);
+    if (cosAngle <= 0.5f) return glm::vec4{pos, range};
+
+    float radius = range / (2.f * cosAngle);
+    return glm::vec4{pos + glm::normalize(glm::vec3{light.dir}) * radius, radius};
+}
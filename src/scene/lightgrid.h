@@ -0,0 +1,73 @@
+#ifndef LIGHTGRID_H
+#define LIGHTGRID_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "utils/scenedata.h"
+
+// Froxel grid over the view frustum, each cluster lists the lights that can reach it
+// screen is split into tiles, depth into slices growing exponentially from near to far
+class LightGrid
+{
+public:
+    static constexpr int TILES_X = 16;
+    static constexpr int TILES_Y = 9;
+    static constexpr int SLICES = 24;
+    static constexpr int NUM_CLUSTERS = TILES_X * TILES_Y * SLICES;
+
+    // contribution below which a light is cut off, one step of an 8 bit framebuffer
+    static constexpr float MIN_ILLUMINANCE = 1.f / 256.f;
+
+    LightGrid() {}
+
+    // rebuild cluster bounds, only needed when the projection changes
+    void setProjection(float widthAngle, float heightAngle, float near, float far);
+
+    // bin every point and spot light into the clusters its range overlaps, slices are binned in parallel
+    // directional lights reach every cluster and are skipped, the shader loops over them separately
+    void build(const std::vector<SceneLightData>& lights, const glm::mat4& view);
+
+    // (offset into indexes, light count) of each cluster, (slice * TILES_Y + y) * TILES_X + x
+    const std::vector<glm::uvec2>& getCells() const;
+
+    // indexes into the light list passed to build, grouped by cluster
+    const std::vector<uint32_t>& getIndexes() const;
+
+    // multiplier taking log(depth / near) to a slice index
+    float getSliceScale() const;
+
+    // distance at which attenuation drops a light below MIN_ILLUMINANCE, infinite if it never does
+    static float getRange(const SceneLightData& light);
+
+    // world space sphere holding everything the light reaches within range, xyz center and w radius
+    static glm::vec4 getBoundingSphere(const SceneLightData& light, float range);
+
+    // move directional lights ahead of the rest keeping their order, they skip the grid and light every fragment
+    // returns how many there are
+    static int orderLights(std::vector<SceneLightData>& lights);
+
+private:
+    float m_near = 0.1f;
+    float m_far = 100.f;
+
+    // view space bounds of each cluster, SoA so the sphere test streams through them
+    std::vector<float> m_minX, m_minY, m_minZ;
+    std::vector<float> m_maxX, m_maxY, m_maxZ;
+    std::vector<float> m_sliceDepths; // SLICES + 1 boundaries, positive distances from the eye
+
+    // view space bounding sphere of each binned light, xyz center and w radius
+    std::vector<glm::vec4> m_spheres;
+    std::vector<uint32_t> m_lightIds;
+
+    // per slice scratch, concatenated once every slice is binned
+    std::vector<std::vector<uint32_t>> m_sliceIndexes;
+    std::vector<std::vector<uint32_t>> m_sliceCounts;
+
+    std::vector<glm::uvec2> m_cells;
+    std::vector<uint32_t> m_indexes;
+
+    void binSlice(int slice);
+};
+
+#endif // LIGHTGRID_H
@@ -0,0 +1,67 @@
+#include "renderqueue.h"
+#include <algorithm>
+#include <array>
+
+uint64_t RenderQueue::makeKey(unsigned int variant,
+                              unsigned int palette,
+                              unsigned int diffuse,
+                              unsigned int normal,
+                              unsigned int geom,
+                              float depth) {
+    auto field = [](uint64_t val, int bits) { return val & ((uint64_t{1} << bits) - 1); };
+
+    // quantize normalized depth so nearer shapes sort first within same state
+    uint64_t quantDepth = static_cast<uint64_t>(std::clamp(depth, 0.f, 1.f) * ((1 << DEPTH_BITS) - 1));
+
+    uint64_t key = field(variant, VARIANT_BITS);
+    key = (key << PALETTE_BITS) | field(palette, PALETTE_BITS);
+    key = (key << DIFFUSE_BITS) | field(diffuse, DIFFUSE_BITS);
+    key = (key << NORMAL_BITS) | field(normal, NORMAL_BITS);
+    key = (key << GEOM_BITS) | field(geom, GEOM_BITS);
+    key = (key << DEPTH_BITS) | quantDepth;
+
+    return key;
+}
+
+uint64_t RenderQueue::stateOf(uint64_t key) {
+    return key >> DEPTH_BITS;
+}
+
+void RenderQueue::clear() {
+    m_items.clear();
+}
+
+void RenderQueue::push(uint64_t key, int shape) {
+    m_items.push_back({key, shape});
+}
+
+void RenderQueue::sort() {
+    m_temp.resize(m_items.size());
+
+    // LSD radix sort, one byte per pass
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::array<size_t, 256> counts{};
+
+        for (const RenderItem& item : m_items) counts[(item.key >> shift) & 0xFF]++;
+
+        // skip pass if every key shares this byte
+        if (std::any_of(counts.begin(), counts.end(), [&](size_t c) { return c == m_items.size(); })) continue;
+
+        // prefix sum into bucket offsets
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t c = count;
+            count = offset;
+            offset += c;
+        }
+
+        // stable scatter into scratch
+        for (const RenderItem& item : m_items) m_temp[counts[(item.key >> shift) & 0xFF]++] = item;
+
+        m_items.swap(m_temp);
+    }
+}
+
+const std::vector<RenderItem>& RenderQueue::getItems() const {
+    return m_items;
+}
@@ -0,0 +1,51 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+// Sort key of a single shape, ordered from most to least expensive state
+struct RenderItem {
+    uint64_t key;
+    int shape; // index into scene shape list
+};
+
+class RenderQueue
+{
+public:
+    // key layout (msb -> lsb): variant | palette | diffuse | normal | geometry | depth
+    static constexpr int VARIANT_BITS = 4;
+    static constexpr int PALETTE_BITS = 10;
+    static constexpr int DIFFUSE_BITS = 11;
+    static constexpr int NORMAL_BITS = 11;
+    static constexpr int GEOM_BITS = 12;
+    static constexpr int DEPTH_BITS = 16;
+
+    static_assert(VARIANT_BITS + PALETTE_BITS + DIFFUSE_BITS + NORMAL_BITS + GEOM_BITS + DEPTH_BITS == 64,
+                  "Render key must fill 64 bits");
+
+    // ids wider than their field wrap, which only costs extra binds since batches compare real bindings
+    static uint64_t makeKey(unsigned int variant,
+                            unsigned int palette,
+                            unsigned int diffuse,
+                            unsigned int normal,
+                            unsigned int geom,
+                            float depth);
+
+    // key with depth bits stripped, equal for shapes with identical state
+    static uint64_t stateOf(uint64_t key);
+
+    void clear();
+
+    void push(uint64_t key, int shape);
+
+    void sort();
+
+    const std::vector<RenderItem>& getItems() const;
+
+private:
+    std::vector<RenderItem> m_items;
+    std::vector<RenderItem> m_temp; // radix sort scratch
+};
+
+#endif // RENDERQUEUE_H
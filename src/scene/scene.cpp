@@ -1,10 +1,12 @@
 #include "scene.h"
-#include "primitive/cone.h"
-#include "primitive/cube.h"
-#include "primitive/cylinder.h"
-#include "primitive/sphere.h"
-#include "utils/uniloader.h"
 #include "utils/debug.h"
+#include "utils/gpuprofiler.h"
+#include "utils/profiler.h"
+#include "utils/stats.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <tuple>
 
 using namespace Debug;
 using namespace UniLoader;
@@ -15,7 +17,9 @@ Scene::Scene(const RenderData& metaData,
              int param1, int param2) :
     m_global(metaData.globalData),
     m_shapes(metaData.shapes),
-    m_lights(metaData.lights)
+    m_lights(metaData.lights),
+    m_param1(param1),
+    m_param2(param2)
 {
     m_cam = Camera {
         metaData.cameraData.pos,
@@ -27,6 +31,49 @@ Scene::Scene(const RenderData& metaData,
         far
     };
 
+    // Init uniform buffers, lights and globals only change on scene load
+    m_camBlock = UniformBuffer{CAMERA_BLOCK, sizeof(CameraBlock)};
+    m_globalBlock = UniformBuffer{GLOBALS_BLOCK, sizeof(GlobalBlock)};
+    m_materialBlock = UniformBuffer{MATERIALS_BLOCK, sizeof(MaterialBlock) * MAX_MATERIALS};
+
+    // Init instance buffer with room for every shape and projectile
+    m_instanceBuffer = InstanceBuffer{m_shapes.size() + MAX_PROJECTILES};
+
+    // Init texture streaming, white diffuse and flat normal stand in until textures are resident
+    m_pixelBuffer = PixelBuffer{PIXEL_BUFFERS};
+    m_diffusePlaceholder = Texture{glm::u8vec4{255, 255, 255, 255}, 0};
+    m_normalPlaceholder = Texture{glm::u8vec4{128, 128, 255, 255}, 1};
+    uploadTexture(m_diffusePlaceholder);
+    uploadTexture(m_normalPlaceholder);
+
+    // Init light buffers, directional lights go first since they skip the grid and light every fragment
+    int numDirLights = LightGrid::orderLights(m_lights);
+
+    m_lightData = TextureBuffer{GL_RGBA32F};
+    m_lightCells = TextureBuffer{GL_RG32UI};
+    m_lightIndexes = TextureBuffer{GL_R32UI};
+
+    for (const SceneLightData& light : m_lights) {
+        switch (light.type) {
+        case LightType::LIGHT_DIRECTIONAL: m_lightFeatures |= featureBit(ShaderFeature::FEATURE_DIR_LIGHTS); break;
+        case LightType::LIGHT_POINT: m_lightFeatures |= featureBit(ShaderFeature::FEATURE_POINT_LIGHTS); break;
+        case LightType::LIGHT_SPOT: m_lightFeatures |= featureBit(ShaderFeature::FEATURE_SPOT_LIGHTS); break;
+        }
+    }
+
+    passLightData(m_lightData, m_lights);
+    passGlobalBlock(m_globalBlock, m_global, numDirLights);
+
+    // Start tessellating every LOD of every primitive type in parallel before blocking on any
+    for (const RenderShapeData& shape : m_shapes) {
+        if (shape.primitive.type == PrimitiveType::PRIMITIVE_MESH) continue;
+
+        for (int level = 0; level < LOD_LEVELS; ++level) {
+            auto [p1, p2] = getLodParams(level);
+            m_tessCache.request(shape.primitive.type, p1, p2);
+        }
+    }
+
     for (int i = 0; i < m_shapes.size(); ++i) {
         RenderShapeData& shape = m_shapes[i];
 
@@ -36,19 +83,26 @@ Scene::Scene(const RenderData& metaData,
         if (!m_animMap.contains(meshfile) && !meshfile.empty()) {
             const AnimData& animData = metaData.animData.at(meshfile);
             // Only add if animations are present
-            if (!animData.animations.empty()) m_animMap.emplace(meshfile, animData);
+            if (!animData.animations.empty()) {
+                m_animMap.emplace(meshfile, animData);
+                // One skinning palette buffer per animator, shared by all its meshes
+                m_paletteMap.emplace(meshfile, TextureBuffer{GL_RGBA32F});
+            }
         }
 
         // Add primitive to geom map if not present and not mesh
         if (shape.primitive.type != PrimitiveType::PRIMITIVE_MESH) {
             if (!m_primMap.contains(getGeomKey(shape))) {
-                addPrim(shape, param1, param2);
+                addPrim(shape);
             }
         }
 
         // Init mesh and texture data
         initModelAndTex(shape);
 
+        // Init material index
+        shape.materialIdx = addMaterial(shape.primitive.material);
+
         // Init physics data
         initPhys(shape, i);
     }
@@ -56,6 +110,9 @@ Scene::Scene(const RenderData& metaData,
     // Init index of first projectile instance in shape list
     m_projectileFront = m_shapes.size();
 
+    // Init hierarchy over static shapes for culling and collision queries
+    buildStaticBvh();
+
     // Init random number generator
     std::random_device rd;
     gen = std::default_random_engine(rd());
@@ -95,6 +152,22 @@ void Scene::initModelAndTex(const RenderShapeData& shape) {
     }
 }
 
+int Scene::addMaterial(const SceneMaterial& material) {
+    MaterialBlock block = getMaterialBlock(material);
+
+    // Reuse index of identical material if present
+    for (int i = 0; i < m_materials.size(); ++i) {
+        if (std::memcmp(&m_materials[i], &block, sizeof(MaterialBlock)) == 0) return i;
+    }
+
+    if (m_materials.size() >= MAX_MATERIALS) throw std::runtime_error("Too many unique materials");
+
+    m_materials.push_back(block);
+    m_materialsDirty = true;
+
+    return m_materials.size() - 1;
+}
+
 void Scene::initPhys(const RenderShapeData& shape, int i) {
     // Add collision instance to collision map
     m_collMap.emplace(i, Collision{shape});
@@ -107,92 +180,421 @@ void Scene::initPhys(const RenderShapeData& shape, int i) {
     }
 }
 
-bool Scene::draw(GLuint shader) {
+void Scene::compileShaders(ShaderVariants& shaders) const {
+    for (const RenderShapeData& shape : m_shapes) {
+        bool hasNormMap = shape.primitive.material.bumpMap.isUsed;
+        bool hasBones = m_paletteMap.contains(shape.primitive.meshfile);
+
+        uint32_t features = m_lightFeatures;
+        if (hasBones) features |= featureBit(ShaderFeature::FEATURE_SKINNED);
+
+        // Normal mapped shapes also draw without it while the toggle is off
+        shaders.get(features);
+        if (hasNormMap) shaders.get(features | featureBit(ShaderFeature::FEATURE_NORMAL_MAP));
+    }
+}
+
+bool Scene::draw(ShaderVariants& shaders) {
+    PROFILE_ZONE("Scene::draw");
+    GPU_ZONE("Scene::draw");
+
     glErrorCheck();
 
-    passGlobalVars(shader, m_global);
-    passCamVars(shader, m_cam);
+    // Restart per-frame counters, uploads below count towards this frame
+    stats.drawCalls = 0;
+    stats.triangles = 0;
+    stats.textureBinds = 0;
+    stats.uniformUploads = 0;
+    stats.bytesUploaded = 0;
 
-    for (int i = 0; i < MAX_LIGHTS; ++i) {
-        if (i >= m_lights.size()) {
-            passLightVars(shader, SceneLightData{}, i, true);
-        } else {
-            passLightVars(shader, m_lights[i], i, false);
+    // Upload any finished retessellations and texture decodes
+    uploadTessellations();
+    uploadTextures();
+
+    // Upload camera block and rebin lights only if view or projection changed
+    if (m_cam.isDirty()) {
+        PROFILE_ZONE("Scene::uploadCamera");
+
+        m_lightGrid.setProjection(m_cam.getWidthAngle(), m_cam.getHeightAngle(), m_cam.getNear(), m_cam.getFar());
+        m_lightGrid.build(m_lights, m_cam.getView());
+        passLightGrid(m_lightCells, m_lightIndexes, m_lightGrid);
+
+        passCamBlock(m_camBlock, m_cam, m_lightGrid);
+        m_cam.clearDirty();
+    }
+
+    stats.lights = m_lights.size();
+    stats.lightIndexes = m_lightGrid.getIndexes().size();
+
+    // Upload each animator's palette once per frame if it changed
+    for (auto& [meshfile, anim] : m_animMap) {
+        if (!anim.isDirty()) continue;
+
+        PROFILE_ZONE("Scene::uploadPalette");
+        const auto& palette = anim.getPalette();
+        m_paletteMap.at(meshfile).update(palette.data(), palette.size() * sizeof(glm::vec4));
+        stats.bytesUploaded += palette.size() * sizeof(glm::vec4);
+        anim.clearDirty();
+    }
+
+    // Upload materials if any were added
+    if (m_materialsDirty) {
+        passMaterialBlock(m_materialBlock, m_materials);
+        m_materialsDirty = false;
+    }
+
+    // Sort shapes by state, group into batches and upload their instances
+    buildBatches();
+    m_instanceBuffer.update(m_instances);
+    stats.bytesUploaded += m_instances.size() * sizeof(InstanceData);
+
+    // Bind light list and grid once for every batch
+    m_lightData.bind(LIGHT_DATA_SLOT);
+    m_lightCells.bind(LIGHT_CELLS_SLOT);
+    m_lightIndexes.bind(LIGHT_INDEXES_SLOT);
+    stats.textureBinds += 3;
+
+    const TextureArray* boundDiffuse = nullptr;
+    const TextureArray* boundNormal = nullptr;
+    const TextureBuffer* boundPalette = nullptr;
+    int boundVariant = -1;
+
+    stats.stateChanges = 0;
+
+    for (const Batch& batch : m_batches) {
+        GPU_ZONE("Scene::drawBatch");
+
+        // Activate diffuse map slot if available and changed
+        if (batch.diffuse && batch.diffuse != boundDiffuse) {
+            glActiveTexture(GL_TEXTURE0 + batch.diffuse->getSlot());
+            glBindTexture(GL_TEXTURE_2D_ARRAY, batch.diffuse->getId());
+
+            boundDiffuse = batch.diffuse;
+            stats.stateChanges++;
+            stats.textureBinds++;
         }
+
+        // Activate normal map slot if available and changed
+        if (batch.normal && batch.normal != boundNormal) {
+            glActiveTexture(GL_TEXTURE0 + batch.normal->getSlot());
+            glBindTexture(GL_TEXTURE_2D_ARRAY, batch.normal->getId());
+
+            boundNormal = batch.normal;
+            stats.stateChanges++;
+            stats.textureBinds++;
+        }
+
+        // Only rebind palette when switching animators
+        if (batch.palette && batch.palette != boundPalette) {
+            batch.palette->bind(PALETTE_SLOT);
+            boundPalette = batch.palette;
+            stats.stateChanges++;
+            stats.textureBinds++;
+        }
+
+        // Only switch programs when variant changes, queue sorts by variant first
+        if (batch.getVariant() != boundVariant) {
+            glUseProgram(shaders.get(batch.getVariant() | m_lightFeatures).program);
+            boundVariant = batch.getVariant();
+            stats.stateChanges++;
+        }
+
+        // Geometry counts the draw call and its triangles
+        batch.geom->drawInstanced(m_instanceBuffer, batch.first, batch.count, batch.lod);
+
+        stats.stateChanges++;
     }
 
+    stats.stateChangesSaved = m_unsortedChanges - stats.stateChanges;
+
+    // Unbind textures once after all batches
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    glErrorCheck();
+
+    return true;
+}
+
+void Scene::buildBatches() {
+    PROFILE_ZONE("Scene::buildBatches");
+
+    const glm::vec3& camPos = m_cam.getPos();
+    const glm::vec3& look = m_cam.getLook();
+
+    m_queue.clear();
+    m_shapeBindings.resize(m_shapes.size());
+    m_shapeLods.resize(m_shapes.size(), 0);
+    m_shapeLayers.resize(m_shapes.size());
+    m_unsortedChanges = 0;
+
+    cullShapes();
+
     for (int i = 0; i < m_shapes.size(); ++i) {
-        // Fetch current shape
+        // Skip shapes outside view frustum
+        if (!m_visible[i]) continue;
+
         const RenderShapeData& shape = m_shapes[i];
+        const SceneMaterial& material = shape.primitive.material;
 
-        // Activate diffuse map slot if available
-        if (shape.primitive.material.textureMap.isUsed) {
-            const Texture& texture = m_texMap.at(shape.primitive.material.textureMap.filename);
+        // Fetch geometry and texture bindings of shape
+        Batch& batch = m_shapeBindings[i];
+        int level = selectLod(i);
+        const Geometry& geom = getGeom(shape, level);
 
-            glActiveTexture(GL_TEXTURE0 + texture.getSlot());
-            glBindTexture(GL_TEXTURE_2D, texture.getId());
+        // Primitive levels are separate geometries, mesh levels are index ranges of one geometry
+        batch = Batch{&geom, nullptr, nullptr, nullptr, std::min(level, geom.getLodCount() - 1), 0, 0};
 
-            passTextureVars(shader, texture);
-        }
+        // Shapes whose textures share an array share bindings, their layers go per instance
+        glm::ivec2& layers = m_shapeLayers[i];
+        layers = glm::ivec2{0};
 
-        // Activate normal map slot if available
-        if (shape.primitive.material.bumpMap.isUsed && m_normalMapToggled) {
-            const Texture& texture = m_texMap.at(shape.primitive.material.bumpMap.filename);
+        if (material.textureMap.isUsed) {
+            const Texture* diffuse = getResident(material.textureMap.filename, m_diffusePlaceholder);
+            batch.diffuse = diffuse->getArray();
+            layers.x = diffuse->getLayer();
+        }
 
-            glActiveTexture(GL_TEXTURE0 + texture.getSlot());
-            glBindTexture(GL_TEXTURE_2D, texture.getId());
+        if (material.bumpMap.isUsed && m_normalMapToggled) {
+            const Texture* normal = getResident(material.bumpMap.filename, m_normalPlaceholder);
+            batch.normal = normal->getArray();
+            layers.y = normal->getLayer();
+        }
 
-            passTextureVars(shader, texture);
+        if (m_paletteMap.contains(shape.primitive.meshfile)) {
+            batch.palette = &m_paletteMap.at(shape.primitive.meshfile);
         }
 
-        passShapeVars(shader, shape);
+        // Sort nearer shapes first within the same state
+        glm::vec3 pos = m_physMap.contains(i) ? glm::vec3{m_physMap.at(i).getCtm()[3]} : glm::vec3{shape.ctm[3]};
+        float depth = glm::dot(pos - camPos, look) / m_cam.getFar();
+
+        m_queue.push(RenderQueue::makeKey(batch.getVariant(),
+                                          batch.palette ? batch.palette->getId() : 0,
+                                          batch.diffuse ? batch.diffuse->getId() : 0,
+                                          batch.normal ? batch.normal->getId() : 0,
+                                          batch.geom->getId() * LOD_LEVELS + batch.lod,
+                                          depth),
+                     i);
+
+        // Scene-file order binds every texture, palette, VAO and program and unbinds per shape
+        m_unsortedChanges += (batch.diffuse ? 1 : 0) + (batch.normal ? 1 : 0) + (batch.palette ? 1 : 0) + 3;
+    }
+
+    m_queue.sort();
+
+    auto bindings = [](const Batch& b) { return std::tie(b.geom, b.lod, b.diffuse, b.normal, b.palette); };
+
+    m_instances.clear();
+    m_batches.clear();
+
+    for (const RenderItem& item : m_queue.getItems()) {
+        const RenderShapeData& shape = m_shapes[item.shape];
+        const Batch& batch = m_shapeBindings[item.shape];
 
-        // Fetch animation if present
-        if (m_animMap.contains(shape.primitive.meshfile)) {
-            passBoneVars(shader, m_animMap.at(shape.primitive.meshfile));
+        // Start new batch if bindings changed
+        if (m_batches.empty() || bindings(m_batches.back()) != bindings(batch)) {
+            m_batches.push_back(batch);
+            m_batches.back().first = m_instances.size();
         }
 
-        // Fetch physics state if dynamic
-        if (m_physMap.contains(i)) {
-            passPhysVars(shader, m_physMap.at(i));
+        m_batches.back().count++;
+
+        // Use rigid body transform if dynamic
+        if (m_physMap.contains(item.shape)) {
+            glm::mat4 ctm = m_physMap.at(item.shape).getCtm();
+
+            m_instances.push_back({ctm, glm::transpose(glm::inverse(glm::mat3{ctm})), shape.materialIdx, m_shapeLayers[item.shape]});
+        } else {
+            m_instances.push_back({shape.ctm, glm::transpose(shape.ctmInv), shape.materialIdx, m_shapeLayers[item.shape]});
         }
+    }
+}
 
-        getGeom(shape).draw();
+Box Scene::getWorldBox(int i) const {
+    const glm::mat4& ctm = m_physMap.contains(i) ? m_physMap.at(i).getCtm() : m_shapes[i].ctm;
+    const Box objBox = m_collMap.at(i).getObjectBox();
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+    // Transform object space box to world space AABB
+    glm::vec3 center = ctm * glm::vec4{(objBox.min + objBox.max) * 0.5f, 1.f};
+    glm::mat3 absCtm{glm::abs(glm::vec3{ctm[0]}), glm::abs(glm::vec3{ctm[1]}), glm::abs(glm::vec3{ctm[2]})};
+    glm::vec3 extent = absCtm * ((objBox.max - objBox.min) * 0.5f);
+
+    return Box{center - extent, center + extent};
+}
+
+void Scene::buildStaticBvh() {
+    std::vector<Box> boxes;
+    std::vector<int> ids;
+    std::vector<glm::mat4> occluders;
+
+    for (int i = 0; i < m_shapes.size(); ++i) {
+        if (m_physMap.contains(i)) continue;
+
+        // Cover both render and collision bounds so one tree serves both queries
+        boxes.push_back(getWorldBox(i).merge(m_collMap.at(i).getCollisionBox()));
+        ids.push_back(i);
+
+        // Cubes are their own exact occluder, other meshes would need conservative inner hulls
+        if (m_shapes[i].primitive.type == PrimitiveType::PRIMITIVE_CUBE) occluders.push_back(m_shapes[i].ctm);
     }
 
-    glErrorCheck();
+    m_staticBvh = BVH{boxes, ids};
+    m_occlusion.setOccluders(occluders);
+}
 
-    return true;
+void Scene::cullShapes() {
+    PROFILE_ZONE("Scene::cullShapes");
+
+    glm::mat4 viewProj = m_cam.getProj() * m_cam.getView();
+    Frustum frustum{viewProj};
+
+    // Occluders rasterize on the pool while the frustum tests run
+    m_occlusion.render(viewProj);
+
+    m_visible.assign(m_shapes.size(), 0);
+
+    // Static shapes are culled by walking the hierarchy
+    m_candidates.clear();
+    m_staticBvh.queryFrustum(frustum, m_candidates);
+
+    for (int i : m_candidates) m_visible[i] = 1;
+
+    // Dynamic shapes are culled in bulk over SoA bounds
+    m_dynamicIds.clear();
+    for (const auto& [i, _] : m_physMap) m_dynamicIds.push_back(i);
+
+    m_bounds.resize(m_dynamicIds.size());
+
+    for (int j = 0; j < m_dynamicIds.size(); ++j) {
+        Box box = getWorldBox(m_dynamicIds[j]);
+        m_bounds.set(j, (box.min + box.max) * 0.5f, (box.max - box.min) * 0.5f);
+    }
+
+    frustum.cull(m_bounds, m_dynamicVisible);
+
+    for (int j = 0; j < m_dynamicIds.size(); ++j) m_visible[m_dynamicIds[j]] = m_dynamicVisible[j];
+
+    // Skinned shapes are never culled since their pose can leave the bind pose bounds
+    for (int i = 0; i < m_shapes.size(); ++i) {
+        if (m_paletteMap.contains(m_shapes[i].primitive.meshfile)) m_visible[i] = 1;
+    }
+
+    stats.visibleShapes = std::count(m_visible.begin(), m_visible.end(), 1);
+    stats.culledShapes = m_shapes.size() - stats.visibleShapes;
+
+    // Shapes inside the frustum can still hide entirely behind nearer occluders
+    m_occlusion.wait();
+    stats.occludedShapes = 0;
+
+    for (int i = 0; i < m_shapes.size(); ++i) {
+        if (!m_visible[i] || m_paletteMap.contains(m_shapes[i].primitive.meshfile)) continue;
+
+        Box box = getWorldBox(i);
+        if (!m_occlusion.isOccluded((box.min + box.max) * 0.5f, (box.max - box.min) * 0.5f)) continue;
+
+        m_visible[i] = 0;
+        stats.occludedShapes++;
+    }
+
+    stats.visibleShapes -= stats.occludedShapes;
 }
 
-void Scene::addPrim(const RenderShapeData& shape, int param1, int param2) {
-    int key = getGeomKey(shape);
-    switch(shape.primitive.type) {
-        case PrimitiveType::PRIMITIVE_CUBE:
-            m_primMap.emplace(key, std::make_unique<Cube>(param1));
-            break;
-        case PrimitiveType::PRIMITIVE_CONE:
-            m_primMap.emplace(key, std::make_unique<Cone>(param1, param2));
-            break;
-        case PrimitiveType::PRIMITIVE_CYLINDER:
-            m_primMap.emplace(key, std::make_unique<Cylinder>(param1, param2));
-            break;
-        case PrimitiveType::PRIMITIVE_SPHERE:
-            m_primMap.emplace(key, std::make_unique<Sphere>(param1, param2));
-            break;
-        case PrimitiveType::PRIMITIVE_MESH:
-            break;
+void Scene::addPrim(const RenderShapeData& shape) {
+    std::vector<Geometry>& chain = m_primMap[getGeomKey(shape)];
+
+    // Block on initial tessellations, later changes are uploaded asynchronously
+    for (int level = 0; level < LOD_LEVELS; ++level) {
+        auto [p1, p2] = getLodParams(level);
+        chain.emplace_back(m_tessCache.request(shape.primitive.type, p1, p2).get());
     }
 }
 
-const Geometry& Scene::getGeom(const RenderShapeData& shape) {
+const Geometry& Scene::getGeom(const RenderShapeData& shape, int level) {
     int key = getGeomKey(shape);
 
     return m_modelMap.contains(shape.primitive.meshfile) ?
                m_modelMap.at(shape.primitive.meshfile).getGeom(key) :
-               m_primMap.at(key);
+               m_primMap.at(key)[level];
+}
+
+std::pair<int, int> Scene::getLodParams(int level) const {
+    // Halve tessellation per level, primitives clamp to their own minimums
+    return {std::max(1, m_param1 >> level), std::max(3, m_param2 >> level)};
+}
+
+int Scene::selectLod(int i) {
+    int& level = m_shapeLods[i];
+
+    Box box = getWorldBox(i);
+    float radius = glm::length(box.side()) * 0.5f;
+    float dist = glm::max(glm::distance((box.min + box.max) * 0.5f, m_cam.getPos()), EPSILON);
+
+    // Fraction of half screen height covered by bounding sphere
+    float coverage = radius / (dist * glm::tan(m_cam.getHeightAngle() * 0.5f));
+
+    // Each halving of coverage allows one coarser level
+    float lodValue = glm::log2(LOD_FULL_COVERAGE / glm::max(coverage, EPSILON));
+
+    // Only switch once past the level boundary by a margin, so shapes near a boundary do not pop
+    if (lodValue > level + 1 + LOD_HYSTERESIS || lodValue < level - LOD_HYSTERESIS) {
+        level = glm::clamp(static_cast<int>(glm::floor(lodValue)), 0, LOD_LEVELS - 1);
+    }
+
+    return level;
+}
+
+void Scene::uploadTextures() {
+    PROFILE_ZONE("Scene::uploadTextures");
+    GPU_ZONE("Scene::uploadTextures");
+
+    size_t uploaded = 0;
+
+    // Spread uploads over frames so a burst of finished loads does not hitch
+    for (auto& [_, tex] : m_texMap) {
+        if (uploaded >= MAX_UPLOAD_BYTES) break;
+        if (tex.isReady()) uploaded += uploadTexture(tex);
+    }
+
+    stats.bytesUploaded += uploaded;
+}
+
+void Scene::finishStreaming() {
+    PROFILE_ZONE("Scene::finishStreaming");
+
+    for (auto& [_, tex] : m_texMap) {
+        tex.wait();
+        if (tex.isReady()) uploadTexture(tex);
+    }
+
+    for (auto& [_, pending] : m_pendingTess) pending.wait();
+    uploadTessellations();
+}
+
+size_t Scene::uploadTexture(Texture& tex) {
+    std::shared_ptr<const CookedTexture> cooked = tex.takeCooked();
+    const CookedLevel& base = cooked->levels[0];
+
+    // Group by everything a layer must share with the rest of its array
+    TextureArrayKey key{cooked->format, base.width, base.height, tex.getSlot()};
+    auto it = m_texArrays.find(key);
+
+    if (it == m_texArrays.end()) {
+        it = m_texArrays.emplace(key, TextureArray{*cooked, tex.getSlot()}).first;
+    }
+
+    // Layer is copied to the GPU, the cooked mapping is released on return
+    tex.setLayer(&it->second, it->second.add(*cooked, m_pixelBuffer));
+
+    // Growing the array copies its existing layers too, which counts against the budget
+    return it->second.getUploadedBytes();
+}
+
+const Texture* Scene::getResident(const std::string& filename, const Texture& placeholder) const {
+    const Texture& tex = m_texMap.at(filename);
+    return tex.isResident() ? &tex : &placeholder;
 }
 
 int Scene::getGeomKey(const RenderShapeData& shape) {
@@ -202,6 +604,12 @@ int Scene::getGeomKey(const RenderShapeData& shape) {
 }
 
 void Scene::updatePhys(float dt) {
+    PROFILE_ZONE("Scene::updatePhys");
+
+    stats.rigidBodies = 0;
+    stats.collisionTests = 0;
+    stats.contacts = 0;
+
     if (!m_gravityEnabled && !m_torqueEnabled && !m_collisionsEnabled) {
         for (auto& [_, rb] : m_physMap) rb.reset();
         return;
@@ -229,8 +637,12 @@ void Scene::updatePhys(float dt) {
 
     for (auto& [_, rb] : m_physMap) rb.integrate(dt);
 
+    for (auto& [_, rb] : m_physMap) stats.rigidBodies += !rb.atRest();
+
     // collision
     if (m_collisionsEnabled) {
+        PROFILE_ZONE("Scene::collide");
+
         // update dynamic AABBs
         for (auto& [rid, rb] : m_physMap) m_collMap.at(rid).updateBox(rb.getCtm());
 
@@ -242,10 +654,20 @@ void Scene::updatePhys(float dt) {
             // fetch applicant of collision
             const Collision& affector = m_collMap.at(rid);
 
-            // check each collision object (static + dynamic)
-            for (int cid = 0; cid < m_shapes.size(); cid++) {
-                // skip self and previously collided dynamics
-                if (cid == rid || (m_physMap.contains(cid) && cid <= rid)) continue;
+            // fetch static objects near affector from hierarchy
+            m_candidates.clear();
+            m_staticBvh.queryBox(getWorldBox(rid).merge(affector.getCollisionBox()), m_candidates);
+            std::sort(m_candidates.begin(), m_candidates.end());
+
+            // add dynamics not yet collided with affector
+            for (int cid = rid + 1; cid < m_shapes.size(); cid++) {
+                if (m_physMap.contains(cid)) m_candidates.push_back(cid);
+            }
+
+            stats.collisionTests += m_candidates.size();
+
+            // check each candidate collision object (static + dynamic)
+            for (int cid : m_candidates) {
 
                 // fetch recipient of collision
                 const Collision& affectee = m_collMap.at(cid);
@@ -256,6 +678,7 @@ void Scene::updatePhys(float dt) {
                 // if collision detected
                 if (contact) {
                     // std::cout << "collision detected" << std::endl;
+                    stats.contacts++;
 
                     // determine reaction forces
                     m_physMap.at(rid).applyReaction(*contact);
@@ -296,6 +719,9 @@ void Scene::spawn() {
     shape.ctm[3] = glm::vec4{camPos.x, camPos.y - 0.5f, camPos.z, 1.f};
     shape.ctmInv = glm::inverse(shape.ctm);
 
+    // Init material index
+    shape.materialIdx = addMaterial(shape.primitive.material);
+
     // Add projectile to shapes list
     m_shapes.push_back(shape);
 
@@ -327,23 +753,70 @@ void Scene::despawn() {
 
     // Remove first projectile from shape list
     m_shapes.erase(m_shapes.begin() + m_projectileFront);
+    if (m_shapeLods.size() > m_projectileFront) m_shapeLods.erase(m_shapeLods.begin() + m_projectileFront);
 
     // Decrement projectile count
     m_numProjectiles--;
 }
 
 void Scene::clean() {
-    for (auto& [_, prim] : m_primMap) prim.clean();
+    m_camBlock.clean();
+    m_lightData.clean();
+    m_lightCells.clean();
+    m_lightIndexes.clean();
+    m_globalBlock.clean();
+    m_materialBlock.clean();
+    m_instanceBuffer.clean();
+    for (auto& [_, chain] : m_primMap) {
+        for (auto& prim : chain) prim.clean();
+    }
     for (auto& [_, model] : m_modelMap) model.clean();
-    for (auto& [_, tex] : m_texMap) tex.clean();
+    for (auto& [_, texArray] : m_texArrays) texArray.clean();
+    m_pixelBuffer.clean();
+    for (auto& [_, palette] : m_paletteMap) palette.clean();
 }
 
 void Scene::retessellate(int param1, int param2) {
-    for (auto& [_, prim] : m_primMap) prim.updateParams(param1, param2);
+    // Skip if parameters did not change
+    if (param1 == m_param1 && param2 == m_param2) return;
+
+    m_param1 = param1;
+    m_param2 = param2;
+
+    // Request new tessellations of every level, draw uploads them once ready
+    for (const auto& [key, _] : m_primMap) {
+        for (int level = 0; level < LOD_LEVELS; ++level) {
+            auto [p1, p2] = getLodParams(level);
+            m_pendingTess[{key, level}] = m_tessCache.request(static_cast<PrimitiveType>(key), p1, p2);
+        }
+    }
+}
+
+void Scene::uploadTessellations() {
+    PROFILE_ZONE("Scene::uploadTessellations");
+    GPU_ZONE("Scene::uploadTessellations");
+
+    for (auto it = m_pendingTess.begin(); it != m_pendingTess.end();) {
+        // Keep drawing old buffers until worker finishes
+        if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        auto [key, level] = it->first;
+        m_primMap.at(key)[level].update(it->second.get());
+        it = m_pendingTess.erase(it);
+    }
 }
 
 void Scene::updateAnim(float dt) {
+    PROFILE_ZONE("Scene::updateAnim");
+
+    auto start = std::chrono::steady_clock::now();
+
     for (auto& [_, anim] : m_animMap) anim.update(dt);
+
+    stats.animatorMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 void Scene::playAnim() {
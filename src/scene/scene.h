@@ -1,16 +1,46 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include <map>
+#include <tuple>
 #include <unordered_map>
 #include "animation/animator.h"
+#include "buffer/pixelbuffer.h"
+#include "buffer/texturebuffer.h"
 #include "camera/camera.h"
+#include "camera/frustum.h"
+#include "camera/occlusionbuffer.h"
 #include "geometry/model.h"
 #include "geometry/geometry.h"
+#include "lightgrid.h"
+#include "physics/bvh.h"
 #include "physics/collision.h"
 #include "physics/projectile.h"
 #include "physics/rigidbody.h"
+#include "primitive/tesscache.h"
+#include "renderqueue.h"
 #include "texture/texture.h"
 #include "utils/sceneparser.h"
+#include "utils/shadervariants.h"
+#include "utils/uniloader.h"
+
+// Run of instances sharing geometry and texture bindings, drawn with one call
+struct Batch {
+    const Geometry* geom;
+    const TextureArray* diffuse;  // null if unused
+    const TextureArray* normal;   // null if unused or toggled off
+    const TextureBuffer* palette; // null if not skinned
+    int lod;                      // index range of geom, always 0 for primitives
+
+    int first; // offset into instance buffer
+    int count; // number of instances
+
+    // per batch shader features, scene light features are added on top
+    inline int getVariant() const {
+        return (palette ? UniLoader::featureBit(UniLoader::ShaderFeature::FEATURE_SKINNED) : 0) |
+               (normal ? UniLoader::featureBit(UniLoader::ShaderFeature::FEATURE_NORMAL_MAP) : 0);
+    }
+};
 
 class Scene
 {
@@ -22,7 +52,14 @@ public:
           float near, float far,
           int param1, int param2);
 
-    bool draw(GLuint shader);
+    bool draw(ShaderVariants& shaders);
+
+    // compile every shader variant the loaded shapes can draw with, so none compiles mid-frame
+    void compileShaders(ShaderVariants& shaders) const;
+
+    // block until every texture and retessellation has loaded and upload them all, ignoring the per-frame budget
+    // for offline rendering, where frames must not depend on how fast loads finished
+    void finishStreaming();
 
     void clean();
 
@@ -62,12 +99,68 @@ private:
     SceneGlobalData m_global;
     Camera m_cam;
     std::vector<RenderShapeData> m_shapes;
-    std::vector<SceneLightData> m_lights;
+    std::vector<SceneLightData> m_lights; // directional lights first
+    uint32_t m_lightFeatures = 0;         // shader features of the light types present
+
+    UniformBuffer m_camBlock;
+    UniformBuffer m_globalBlock;
+    UniformBuffer m_materialBlock;
+
+    std::vector<UniLoader::MaterialBlock> m_materials;
+    bool m_materialsDirty = true;
+
+    // clustered lighting, grid is rebuilt with the camera block
+    LightGrid m_lightGrid;
+    TextureBuffer m_lightData;
+    TextureBuffer m_lightCells;
+    TextureBuffer m_lightIndexes;
+
+    InstanceBuffer m_instanceBuffer;
+    std::vector<InstanceData> m_instances;
+    std::vector<Batch> m_batches;
+
+    RenderQueue m_queue;
+    std::vector<Batch> m_shapeBindings; // bindings of each shape, indexed like m_shapes
+    int m_unsortedChanges = 0;          // state changes scene-file order would have cost
+
+    BoundsSoA m_bounds;                    // world space bounds of dynamic shapes, indexed like m_dynamicIds
+    std::vector<int> m_dynamicIds;         // shape index of each dynamic bound
+    std::vector<uint8_t> m_dynamicVisible; // frustum test result of each dynamic bound
+    std::vector<uint8_t> m_visible;        // frustum test result of each shape
+
+    BVH m_staticBvh;              // static shapes, built once on scene load
+    std::vector<int> m_candidates; // scratch list of BVH query results
+    OcclusionBuffer m_occlusion;   // static cubes rasterized as occluders each frame
+
+    std::unordered_map<int, std::vector<Geometry>> m_primMap; // LOD chain per primitive type, finest first
+    TessCache m_tessCache;
+    std::map<std::pair<int, int>, std::shared_future<Tessellation>> m_pendingTess; // (type, level) not yet uploaded
+    int m_param1; // tessellation of finest LOD level
+    int m_param2;
+
+    // LOD selection
+    static constexpr int LOD_LEVELS = MAX_LODS;
+    static constexpr float LOD_FULL_COVERAGE = 0.25f; // coverage of half screen height drawn at finest level
+    static constexpr float LOD_HYSTERESIS = 0.2f;     // fraction of a level to overshoot before switching
+    static constexpr float EPSILON = 1e-4f;
+    std::vector<int> m_shapeLods; // current LOD level of each shape, indexed like m_shapes
+
+    // texture streaming
+    static constexpr int PIXEL_BUFFERS = 2;
+    static constexpr size_t MAX_UPLOAD_BYTES = 16 << 20; // per frame, at least one texture always uploads
+    PixelBuffer m_pixelBuffer;
+    Texture m_diffusePlaceholder;
+    Texture m_normalPlaceholder;
+
+    // textures grouped by format, size and slot, one array binding serves every shape in a group
+    using TextureArrayKey = std::tuple<GLenum, uint32_t, uint32_t, unsigned int>;
+    std::map<TextureArrayKey, TextureArray> m_texArrays;
+    std::vector<glm::ivec2> m_shapeLayers; // diffuse and normal layer of each shape, indexed like m_shapes
 
-    std::unordered_map<int, Geometry> m_primMap;
     std::unordered_map<std::string, Texture> m_texMap;
     std::unordered_map<std::string, Model> m_modelMap;
     std::unordered_map<std::string, Animator> m_animMap;
+    std::unordered_map<std::string, TextureBuffer> m_paletteMap;
     std::unordered_map<int, RigidBody> m_physMap;
     std::unordered_map<int, Collision> m_collMap;
 
@@ -86,10 +179,22 @@ private:
     std::default_random_engine gen;
 
     void initModelAndTex(const RenderShapeData& shape);
+    int addMaterial(const SceneMaterial& material);
+    void buildBatches();
+    void cullShapes();
+    void buildStaticBvh();
+    Box getWorldBox(int i) const;
     void initPhys(const RenderShapeData& shape, int i);
 
-    void addPrim(const RenderShapeData& shape, int param1, int param2);
-    const Geometry& getGeom(const RenderShapeData& shape);
+    void uploadTextures();
+    size_t uploadTexture(Texture& tex);
+    const Texture* getResident(const std::string& filename, const Texture& placeholder) const;
+
+    void addPrim(const RenderShapeData& shape);
+    void uploadTessellations();
+    std::pair<int, int> getLodParams(int level) const;
+    int selectLod(int i);
+    const Geometry& getGeom(const RenderShapeData& shape, int level);
     int getGeomKey(const RenderShapeData& shape);
 };
 
@@ -0,0 +1,198 @@
+#include "blockcompress.h"
+#include <algorithm>
+#include <array>
+#include <glm/glm.hpp>
+
+namespace
+{
+    using Block = std::array<glm::u8vec4, 16>;
+
+    // Fetch 4x4 block at (bx, by), clamping reads past the edge
+    Block fetchBlock(const uint8_t* rgba, int width, int height, int bx, int by) {
+        Block block;
+
+        for (int y = 0; y < BlockCompress::BLOCK_DIM; ++y) {
+            int py = std::min(by + y, height - 1);
+
+            for (int x = 0; x < BlockCompress::BLOCK_DIM; ++x) {
+                int px = std::min(bx + x, width - 1);
+                const uint8_t* texel = &rgba[(py * width + px) * 4];
+
+                block[y * BlockCompress::BLOCK_DIM + x] = glm::u8vec4{texel[0], texel[1], texel[2], texel[3]};
+            }
+        }
+
+        return block;
+    }
+
+    uint16_t packRGB565(const glm::vec3& color) {
+        glm::vec3 c = glm::clamp(color, 0.f, 255.f);
+
+        return static_cast<uint16_t>((static_cast<int>(c.r * 31.f / 255.f + 0.5f) << 11) |
+                                     (static_cast<int>(c.g * 63.f / 255.f + 0.5f) << 5) |
+                                     static_cast<int>(c.b * 31.f / 255.f + 0.5f));
+    }
+
+    glm::vec3 unpackRGB565(uint16_t packed) {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+
+        // replicate high bits like hardware decoders do
+        return glm::vec3{(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+    }
+
+    void putU16(uint8_t* dst, uint16_t value) {
+        dst[0] = value & 0xff;
+        dst[1] = value >> 8;
+    }
+
+    // 8 byte color block, always 4 color mode
+    void encodeColor(const Block& block, uint8_t* dst) {
+        glm::vec3 mean{0.f};
+        for (const glm::u8vec4& texel : block) mean += glm::vec3{texel};
+        mean /= 16.f;
+
+        // Covariance of the block's colors
+        float cov[6] = {0.f};
+        for (const glm::u8vec4& texel : block) {
+            glm::vec3 d = glm::vec3{texel} - mean;
+            cov[0] += d.r * d.r; cov[1] += d.r * d.g; cov[2] += d.r * d.b;
+            cov[3] += d.g * d.g; cov[4] += d.g * d.b; cov[5] += d.b * d.b;
+        }
+
+        // Principal axis by power iteration
+        glm::vec3 axis{1.f, 1.f, 1.f};
+        for (int i = 0; i < 4; ++i) {
+            axis = glm::vec3{cov[0] * axis.r + cov[1] * axis.g + cov[2] * axis.b,
+                             cov[1] * axis.r + cov[3] * axis.g + cov[4] * axis.b,
+                             cov[2] * axis.r + cov[4] * axis.g + cov[5] * axis.b};
+
+            float len = glm::length(axis);
+            if (len < 1e-6f) break;
+            axis /= len;
+        }
+
+        // Extremes along the axis, inset by half a palette step to cut quantization error
+        float minT = 0.f, maxT = 0.f;
+        for (const glm::u8vec4& texel : block) {
+            float t = glm::dot(glm::vec3{texel} - mean, axis);
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        float inset = (maxT - minT) / 16.f;
+        uint16_t c0 = packRGB565(mean + axis * (maxT - inset));
+        uint16_t c1 = packRGB565(mean + axis * (minT + inset));
+
+        // 4 color mode needs c0 > c1, equal endpoints mean a solid block
+        if (c0 < c1) std::swap(c0, c1);
+
+        putU16(dst, c0);
+        putU16(dst + 2, c1);
+
+        uint32_t indexes = 0;
+
+        if (c0 != c1) {
+            glm::vec3 e0 = unpackRGB565(c0);
+            glm::vec3 e1 = unpackRGB565(c1);
+            glm::vec3 palette[4] = {e0, e1, (2.f * e0 + e1) / 3.f, (e0 + 2.f * e1) / 3.f};
+
+            for (int i = 0; i < 16; ++i) {
+                glm::vec3 color{block[i]};
+                int best = 0;
+                float bestDist = glm::dot(color - palette[0], color - palette[0]);
+
+                for (int p = 1; p < 4; ++p) {
+                    float dist = glm::dot(color - palette[p], color - palette[p]);
+                    if (dist < bestDist) {
+                        bestDist = dist;
+                        best = p;
+                    }
+                }
+
+                indexes |= static_cast<uint32_t>(best) << (i * 2);
+            }
+        }
+
+        for (int b = 0; b < 4; ++b) dst[4 + b] = (indexes >> (b * 8)) & 0xff;
+    }
+
+    // 8 byte single channel block, 8 value mode
+    void encodeChannel(const Block& block, int channel, uint8_t* dst) {
+        int a0 = 0, a1 = 255;
+        for (const glm::u8vec4& texel : block) {
+            a0 = std::max<int>(a0, texel[channel]);
+            a1 = std::min<int>(a1, texel[channel]);
+        }
+
+        dst[0] = a0;
+        dst[1] = a1;
+
+        uint64_t indexes = 0;
+
+        if (a0 != a1) {
+            // index 0 = a0, 1 = a1, 2..7 step from a0 toward a1
+            int palette[8] = {a0, a1};
+            for (int i = 2; i < 8; ++i) palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+
+            for (int i = 0; i < 16; ++i) {
+                int value = block[i][channel];
+                int best = 0;
+
+                for (int p = 1; p < 8; ++p) {
+                    if (std::abs(value - palette[p]) < std::abs(value - palette[best])) best = p;
+                }
+
+                indexes |= static_cast<uint64_t>(best) << (i * 3);
+            }
+        }
+
+        for (int b = 0; b < 6; ++b) dst[2 + b] = (indexes >> (b * 8)) & 0xff;
+    }
+
+    template <typename F>
+    void compress(const uint8_t* rgba, int width, int height, int blockBytes, std::vector<uint8_t>& out, F encodeBlock) {
+        size_t offset = out.size();
+        out.resize(offset + BlockCompress::compressedSize(width, height, blockBytes));
+
+        for (int by = 0; by < height; by += BlockCompress::BLOCK_DIM) {
+            for (int bx = 0; bx < width; bx += BlockCompress::BLOCK_DIM) {
+                encodeBlock(fetchBlock(rgba, width, height, bx, by), &out[offset]);
+                offset += blockBytes;
+            }
+        }
+    }
+}
+
+namespace BlockCompress
+{
+
+    size_t compressedSize(int width, int height, int blockBytes) {
+        size_t blocksX = (width + BLOCK_DIM - 1) / BLOCK_DIM;
+        size_t blocksY = (height + BLOCK_DIM - 1) / BLOCK_DIM;
+
+        return blocksX * blocksY * blockBytes;
+    }
+
+    void compressBC1(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out) {
+        compress(rgba, width, height, BC1_BLOCK_BYTES, out, [](const Block& block, uint8_t* dst) {
+            encodeColor(block, dst);
+        });
+    }
+
+    void compressBC3(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out) {
+        compress(rgba, width, height, BC3_BLOCK_BYTES, out, [](const Block& block, uint8_t* dst) {
+            encodeChannel(block, 3, dst);
+            encodeColor(block, dst + 8);
+        });
+    }
+
+    void compressBC5(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out) {
+        compress(rgba, width, height, BC5_BLOCK_BYTES, out, [](const Block& block, uint8_t* dst) {
+            encodeChannel(block, 0, dst);
+            encodeChannel(block, 1, dst + 8);
+        });
+    }
+
+}
@@ -0,0 +1,31 @@
+#ifndef BLOCKCOMPRESS_H
+#define BLOCKCOMPRESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU encoders for 4x4 block compressed formats, input is tightly packed RGBA8
+namespace BlockCompress
+{
+    constexpr int BLOCK_DIM = 4;
+
+    // bytes per 4x4 block
+    constexpr int BC1_BLOCK_BYTES = 8;
+    constexpr int BC3_BLOCK_BYTES = 16;
+    constexpr int BC5_BLOCK_BYTES = 16;
+
+    // compressed size of a width x height image, partial edge blocks count as whole
+    size_t compressedSize(int width, int height, int blockBytes);
+
+    // RGB, 1 bit alpha unused (opaque color maps)
+    void compressBC1(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out);
+
+    // RGB + interpolated alpha
+    void compressBC3(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out);
+
+    // R and G as two independent channels (tangent space normal xy)
+    void compressBC5(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out);
+}
+
+#endif // BLOCKCOMPRESS_H
@@ -1,59 +1,66 @@
 #include "texture.h"
-#include <qimage.h>
-#include <stdexcept>
+#include <GL/glew.h>
+#include <chrono>
+#include "utils/profiler.h"
+#include "utils/threadpool.h"
 
 Texture::Texture(const std::string& filename,
                  unsigned int slot) :
     m_slot(slot)
 {
-    // Gen texture ID
-    glGenTextures(1, &m_texId);
+    TextureUsage usage = m_slot == 1 ? TextureUsage::TEXTURE_NORMAL :
+                         GLEW_EXT_texture_compression_s3tc ? TextureUsage::TEXTURE_COLOR :
+                                                             TextureUsage::TEXTURE_COLOR_RAW;
 
-    // Activate texture unit
-    glActiveTexture(GL_TEXTURE0 + m_slot);
+    // Map cooked file, or decode and cook on a miss, off the GL thread
+    m_cooked = ThreadPool::instance().submit([filename, usage]() {
+        PROFILE_ZONE("TextureCache::load");
+        return TextureCache::load(filename, usage);
+    }).share();
+}
+
+Texture::Texture(const glm::u8vec4& color,
+                 unsigned int slot) :
+    m_slot(slot)
+{
+    std::promise<std::shared_ptr<const CookedTexture>> cooked;
+    cooked.set_value(TextureCache::solid(color));
+
+    m_cooked = cooked.get_future().share();
+}
 
-    // Bind texture
-    glBindTexture(GL_TEXTURE_2D, m_texId);
+bool Texture::isReady() const {
+    return m_cooked.valid() && m_cooked.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
 
-    // Load image data
-    QImage data = QImage(QString(filename.c_str()));
+void Texture::wait() const {
+    if (m_cooked.valid()) m_cooked.wait();
+}
 
-    // Throw exception if bad data
-    if (data.isNull()) {
-        throw std::runtime_error("Error loading texture: \"" + filename + "\"");
-    }
+std::shared_ptr<const CookedTexture> Texture::takeCooked() {
+    std::shared_ptr<const CookedTexture> cooked = m_cooked.get();
+    m_cooked = {};
 
-    // Format image to fit OpenGL
-    data = data.convertToFormat(QImage::Format_RGBA8888).flipped(Qt::Vertical);
+    return cooked;
+}
 
-    // Store image data in texture unit
-    glTexImage2D(GL_TEXTURE_2D,
-                 0,
-                 GL_RGBA,
-                 data.width(),
-                 data.height(),
-                 0,
-                 GL_RGBA,
-                 GL_UNSIGNED_BYTE,
-                 data.bits());
+void Texture::setLayer(TextureArray* array, int layer) {
+    m_array = array;
+    m_layer = layer;
+}
 
-    // Set texture parameters
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+bool Texture::isResident() const {
+    return m_array != nullptr;
+}
 
-    // Unbind texture
-    glBindTexture(GL_TEXTURE_2D, 0);
+const TextureArray* Texture::getArray() const {
+    return m_array;
 }
 
-const GLuint Texture::getId() const {
-    return m_texId;
+const int Texture::getLayer() const {
+    return m_layer;
 }
 
 const unsigned int Texture::getSlot() const {
     return m_slot;
 }
-
-void Texture::clean() {
-    glDeleteTextures(1, &m_texId);
-}
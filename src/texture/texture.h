@@ -1,24 +1,53 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
-#include <GL/glew.h>
+#include <future>
+#include <memory>
 #include <string>
+#include <glm/glm.hpp>
+#include "texturearray.h"
+#include "texturecache.h"
 
+// Handle to one image, resident once assigned a layer of a texture array
 class Texture
 {
 public:
+    Texture() {}
+
+    // loads through the cooked cache on the shared thread pool
+    // slot 1 holds normal maps, which cook to two channels
     Texture(const std::string& filename,
             unsigned int slot);
 
-    const GLuint getId() const;
+    // single texel, ready immediately
+    Texture(const glm::u8vec4& color,
+            unsigned int slot);
 
-    const unsigned int getSlot() const;
+    // true once loading has finished and the layer is not yet assigned
+    bool isReady() const;
+
+    // block until loading has finished
+    void wait() const;
+
+    // hand cooked levels over for upload, rethrows load errors
+    std::shared_ptr<const CookedTexture> takeCooked();
+
+    void setLayer(TextureArray* array, int layer);
 
-    void clean();
+    bool isResident() const;
+
+    const TextureArray* getArray() const;
+
+    const int getLayer() const;
+
+    const unsigned int getSlot() const;
 
 private:
-    GLuint m_texId;
-    unsigned int m_slot;
+    std::shared_future<std::shared_ptr<const CookedTexture>> m_cooked; // released once handed over
+
+    TextureArray* m_array = nullptr;
+    int m_layer = 0;
+    unsigned int m_slot = 0;
 };
 
 #endif // TEXTURE_H
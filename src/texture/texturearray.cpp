@@ -0,0 +1,164 @@
+#include "texturearray.h"
+#include <algorithm>
+#include <cstdint>
+
+TextureArray::TextureArray(const CookedTexture& layout,
+                           unsigned int slot) :
+    m_slot(slot),
+    m_format(layout.format),
+    m_compressed(layout.compressed),
+    m_levels(layout.levels)
+{}
+
+int TextureArray::add(const CookedTexture& cooked, PixelBuffer& pbo) {
+    m_uploadedBytes = 0;
+
+    // Double storage when full
+    if (m_numLayers == m_capacity) grow(std::max(INITIAL_LAYERS, m_capacity * 2));
+
+    uploadLayer(m_numLayers, cooked, pbo);
+    m_uploadedBytes += cooked.size;
+
+    return m_numLayers++;
+}
+
+size_t TextureArray::getUploadedBytes() const {
+    return m_uploadedBytes;
+}
+
+const GLuint TextureArray::getId() const {
+    return m_texId;
+}
+
+const unsigned int TextureArray::getSlot() const {
+    return m_slot;
+}
+
+void TextureArray::clean() {
+    glDeleteTextures(1, &m_texId);
+    m_texId = 0;
+    m_capacity = 0;
+    m_numLayers = 0;
+}
+
+size_t TextureArray::getLevelBytes(int i) const {
+    const CookedLevel& level = m_levels[i];
+    return m_compressed ? level.size : size_t{level.width} * level.height * 4;
+}
+
+void TextureArray::grow(int capacity) {
+    GLuint oldTexId = m_texId;
+
+    // Gen texture ID
+    glGenTextures(1, &m_texId);
+
+    // Activate texture unit
+    glActiveTexture(GL_TEXTURE0 + m_slot);
+
+    // Bind texture
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texId);
+
+    // Immutable storage where available (GL 4.2 or ARB_texture_storage)
+    if (GLEW_ARB_texture_storage) {
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_levels.size(), m_format, m_levels[0].width, m_levels[0].height, capacity);
+    } else {
+        // Otherwise define every level up front so the texture is complete
+        for (int i = 0; i < m_levels.size(); ++i) {
+            const CookedLevel& level = m_levels[i];
+
+            if (m_compressed) {
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, i, m_format, level.width, level.height, capacity, 0,
+                                       level.size * capacity, nullptr);
+            } else {
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, i, m_format, level.width, level.height, capacity, 0,
+                             GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            }
+        }
+    }
+
+    // Set texture parameters, mip chain was built when cooking
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, m_levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // GL 4.1 has no glCopyImageSubData, so bounce existing layers through a buffer object
+    // readback and upload both stay on the GPU, no CPU copy of the layers is kept
+    if (m_numLayers > 0) {
+        GLuint copyBuffer;
+        glGenBuffers(1, &copyBuffer);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, copyBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, getLevelBytes(0) * m_numLayers, nullptr, GL_STREAM_COPY);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        for (int i = 0; i < m_levels.size(); ++i) {
+            const CookedLevel& level = m_levels[i];
+            size_t size = getLevelBytes(i) * m_numLayers;
+
+            // Pack every layer of the level, old storage holds exactly m_numLayers of them
+            glBindTexture(GL_TEXTURE_2D_ARRAY, oldTexId);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, copyBuffer);
+
+            if (m_compressed) {
+                glGetCompressedTexImage(GL_TEXTURE_2D_ARRAY, i, nullptr);
+            } else {
+                glGetTexImage(GL_TEXTURE_2D_ARRAY, i, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            // Unpack into the leading layers of the new storage
+            glBindTexture(GL_TEXTURE_2D_ARRAY, m_texId);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, copyBuffer);
+
+            if (m_compressed) {
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, 0, level.width, level.height, m_numLayers,
+                                          m_format, size, nullptr);
+            } else {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, 0, level.width, level.height, m_numLayers,
+                                GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            }
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            m_uploadedBytes += size;
+        }
+
+        glDeleteBuffers(1, &copyBuffer);
+    }
+
+    glDeleteTextures(1, &oldTexId);
+    m_capacity = capacity;
+
+    // Unbind texture
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::uploadLayer(int layer, const CookedTexture& cooked, PixelBuffer& pbo) {
+    // Activate texture unit
+    glActiveTexture(GL_TEXTURE0 + m_slot);
+
+    // Bind texture
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texId);
+
+    // Copy every level into pbo at once, the transfers to the texture run asynchronously
+    pbo.stage(cooked.data, cooked.size);
+
+    for (int i = 0; i < cooked.levels.size(); ++i) {
+        const CookedLevel& level = cooked.levels[i];
+        const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(level.offset));
+
+        if (m_compressed) {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level.width, level.height, 1,
+                                      m_format, level.size, offset);
+        } else {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level.width, level.height, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, offset);
+        }
+    }
+
+    pbo.unbind();
+
+    // Unbind texture
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
@@ -0,0 +1,52 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+#include <GL/glew.h>
+#include <vector>
+#include "buffer/pixelbuffer.h"
+#include "texturecache.h"
+
+// Layers of one format and size sharing a single GL_TEXTURE_2D_ARRAY
+class TextureArray
+{
+public:
+    TextureArray() {}
+
+    // format, size and mip count are taken from layout
+    TextureArray(const CookedTexture& layout,
+                 unsigned int slot);
+
+    // append layer through pbo, growing storage when full, returns layer index
+    // cooked is no longer referenced once this returns
+    int add(const CookedTexture& cooked, PixelBuffer& pbo);
+
+    // bytes transferred by the last add, including existing layers copied into grown storage
+    size_t getUploadedBytes() const;
+
+    const GLuint getId() const;
+
+    const unsigned int getSlot() const;
+
+    void clean();
+
+private:
+    GLuint m_texId = 0;
+    unsigned int m_slot = 0;
+
+    GLenum m_format = GL_RGBA8;
+    bool m_compressed = false;
+    std::vector<CookedLevel> m_levels; // shared by every layer
+    static constexpr int INITIAL_LAYERS = 4;
+    int m_capacity = 0; // allocated layers
+    int m_numLayers = 0;
+    size_t m_uploadedBytes = 0;
+
+    // new storage for capacity layers, existing layers are copied over on the GPU
+    void grow(int capacity);
+    void uploadLayer(int layer, const CookedTexture& cooked, PixelBuffer& pbo);
+
+    // bytes of one layer of level i
+    size_t getLevelBytes(int i) const;
+};
+
+#endif // TEXTUREARRAY_H
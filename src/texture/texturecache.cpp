@@ -0,0 +1,267 @@
+#include "texturecache.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <glm/glm.hpp>
+#include "blockcompress.h"
+#include "utils/hash.h"
+
+namespace
+{
+    constexpr char MAGIC[4] = {'K', 'T', 'X', 'C'};
+    constexpr uint32_t DATA_ALIGN = 16;
+
+    // Fixed layout at the start of every cooked file, followed by the level table and level data
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t format;     // GL internal format
+        uint32_t compressed; // 0 or 1
+        uint32_t numLevels;
+        uint32_t dataOffset; // from start of file
+    };
+
+    QString cachePath(const std::string& filename, TextureUsage usage) {
+        QFileInfo info{QString::fromStdString(filename)};
+
+        std::string key = info.absoluteFilePath().toStdString() + '|' +
+                          std::to_string(info.size()) + '|' +
+                          std::to_string(info.lastModified().toMSecsSinceEpoch()) + '|' +
+                          std::to_string(static_cast<int>(usage)) + '|' +
+                          std::to_string(TextureCache::VERSION);
+
+        QDir dir{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/textures"};
+        dir.mkpath(".");
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.ktxc", static_cast<unsigned long long>(hashString(key)));
+
+        return dir.filePath(QString(name));
+    }
+
+    glm::vec3 decodeNormal(const uint8_t* texel) {
+        return glm::vec3{texel[0], texel[1], texel[2]} / 127.5f - 1.f;
+    }
+
+    // Halve with a 2x2 box filter, odd edges repeat their last row or column
+    // normals are averaged as vectors and renormalized so minified bumps flatten out correctly
+    std::vector<uint8_t> downsample(const std::vector<uint8_t>& src, int width, int height, bool isNormal) {
+        int dstWidth = std::max(1, width / 2);
+        int dstHeight = std::max(1, height / 2);
+        std::vector<uint8_t> dst(dstWidth * dstHeight * 4);
+
+        for (int y = 0; y < dstHeight; ++y) {
+            const uint8_t* row0 = &src[std::min(2 * y, height - 1) * width * 4];
+            const uint8_t* row1 = &src[std::min(2 * y + 1, height - 1) * width * 4];
+
+            for (int x = 0; x < dstWidth; ++x) {
+                int x0 = std::min(2 * x, width - 1) * 4;
+                int x1 = std::min(2 * x + 1, width - 1) * 4;
+                uint8_t* out = &dst[(y * dstWidth + x) * 4];
+
+                if (isNormal) {
+                    glm::vec3 n = decodeNormal(row0 + x0) + decodeNormal(row0 + x1) +
+                                  decodeNormal(row1 + x0) + decodeNormal(row1 + x1);
+
+                    float len = glm::length(n);
+                    n = len > 0.f ? n / len : glm::vec3{0.f, 0.f, 1.f};
+
+                    for (int c = 0; c < 3; ++c) out[c] = static_cast<uint8_t>(glm::clamp((n[c] + 1.f) * 127.5f + 0.5f, 0.f, 255.f));
+                    out[3] = 255;
+                } else {
+                    for (int c = 0; c < 4; ++c) {
+                        out[c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4;
+                    }
+                }
+            }
+        }
+
+        return dst;
+    }
+
+    // Decode source image and build the full cooked file in memory
+    std::vector<uint8_t> cook(const std::string& filename, TextureUsage usage) {
+        // Load image data
+        QImage image = QImage(QString(filename.c_str()));
+
+        // Throw exception if bad data
+        if (image.isNull()) {
+            throw std::runtime_error("Error loading texture: \"" + filename + "\"");
+        }
+
+        // Format image to fit OpenGL
+        image = image.convertToFormat(QImage::Format_RGBA8888).flipped(Qt::Vertical);
+
+        int width = image.width();
+        int height = image.height();
+
+        // Tightly packed copy, scan lines may be padded
+        std::vector<uint8_t> pixels(width * height * 4);
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(&pixels[y * width * 4], image.scanLine(y), width * 4);
+        }
+
+        // Pick format from usage and content
+        bool translucent = false;
+        for (size_t i = 3; i < pixels.size() && !translucent; i += 4) translucent = pixels[i] < 255;
+
+        GLenum format = GL_RGBA8;
+        bool compressed = true;
+        void (*compress)(const uint8_t*, int, int, std::vector<uint8_t>&) = nullptr;
+
+        switch (usage) {
+        case TextureUsage::TEXTURE_COLOR:
+            format = translucent ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            compress = translucent ? BlockCompress::compressBC3 : BlockCompress::compressBC1;
+            break;
+        case TextureUsage::TEXTURE_NORMAL:
+            format = GL_COMPRESSED_RG_RGTC2;
+            compress = BlockCompress::compressBC5;
+            break;
+        case TextureUsage::TEXTURE_COLOR_RAW:
+            compressed = false;
+            break;
+        }
+
+        // Build and encode every level down to 1x1
+        std::vector<CookedLevel> levels;
+        std::vector<uint8_t> data;
+
+        while (true) {
+            size_t offset = data.size();
+
+            if (compressed) {
+                compress(pixels.data(), width, height, data);
+            } else {
+                data.insert(data.end(), pixels.begin(), pixels.end());
+            }
+
+            levels.push_back({static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                              static_cast<uint32_t>(offset), static_cast<uint32_t>(data.size() - offset)});
+
+            if (width == 1 && height == 1) break;
+
+            pixels = downsample(pixels, width, height, usage == TextureUsage::TEXTURE_NORMAL);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+
+        // Header, level table, then aligned level data
+        size_t tableEnd = sizeof(FileHeader) + levels.size() * sizeof(CookedLevel);
+        uint32_t dataOffset = (tableEnd + DATA_ALIGN - 1) / DATA_ALIGN * DATA_ALIGN;
+
+        FileHeader header{{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]}, TextureCache::VERSION, format, compressed,
+                          static_cast<uint32_t>(levels.size()), dataOffset};
+
+        std::vector<uint8_t> file(dataOffset + data.size(), 0);
+        std::memcpy(file.data(), &header, sizeof(FileHeader));
+        std::memcpy(file.data() + sizeof(FileHeader), levels.data(), levels.size() * sizeof(CookedLevel));
+        std::memcpy(file.data() + dataOffset, data.data(), data.size());
+
+        return file;
+    }
+
+    // Write through a per-thread temp file so readers never map a partial file
+    bool write(const QString& path, const std::vector<uint8_t>& bytes) {
+        size_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        QString tmpPath = path + "." + QString::number(static_cast<int>(threadId & 0xffff)) + ".tmp";
+        QFile tmp{tmpPath};
+
+        if (!tmp.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+        bool ok = tmp.write(reinterpret_cast<const char*>(bytes.data()), bytes.size()) == static_cast<long long>(bytes.size());
+        tmp.close();
+
+        // Losing a race to another writer of the same key is fine, both wrote identical bytes
+        if (!ok || !tmp.rename(path)) {
+            QFile::remove(tmpPath);
+            return QFile::exists(path);
+        }
+
+        return true;
+    }
+
+    // Validate a cooked file held in bytes, null if stale or truncated
+    std::shared_ptr<CookedTexture> parse(const uint8_t* bytes, size_t size) {
+        if (!bytes || size < sizeof(FileHeader)) return nullptr;
+
+        FileHeader header;
+        std::memcpy(&header, bytes, sizeof(FileHeader));
+
+        size_t tableEnd = sizeof(FileHeader) + static_cast<size_t>(header.numLevels) * sizeof(CookedLevel);
+
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != TextureCache::VERSION ||
+            tableEnd > size || header.dataOffset < tableEnd || header.dataOffset > size) {
+            return nullptr;
+        }
+
+        auto cooked = std::make_shared<CookedTexture>();
+        cooked->format = header.format;
+        cooked->compressed = header.compressed != 0;
+        cooked->levels.resize(header.numLevels);
+        std::memcpy(cooked->levels.data(), bytes + sizeof(FileHeader), header.numLevels * sizeof(CookedLevel));
+
+        cooked->data = bytes + header.dataOffset;
+        cooked->size = size - header.dataOffset;
+
+        for (const CookedLevel& level : cooked->levels) {
+            if (static_cast<size_t>(level.offset) + level.size > cooked->size) return nullptr;
+        }
+
+        return cooked;
+    }
+
+    // Map a cooked file, null if missing or stale
+    std::shared_ptr<CookedTexture> map(const QString& path) {
+        auto file = std::make_shared<QFile>(path);
+        if (!file->open(QIODevice::ReadOnly)) return nullptr;
+
+        auto cooked = parse(file->map(0, file->size()), file->size());
+        if (cooked) cooked->file = std::move(file);
+
+        return cooked;
+    }
+}
+
+namespace TextureCache
+{
+
+    std::shared_ptr<const CookedTexture> load(const std::string& filename, TextureUsage usage) {
+        QString path = cachePath(filename, usage);
+
+        if (auto cooked = map(path)) return cooked;
+
+        // Miss, cook and write once so later loads only map
+        std::vector<uint8_t> bytes = cook(filename, usage);
+
+        if (write(path, bytes)) {
+            if (auto cooked = map(path)) return cooked;
+        }
+
+        // Cache is unwritable, serve this load from memory (moving keeps data pointing into the same buffer)
+        auto cooked = parse(bytes.data(), bytes.size());
+        cooked->bytes = std::move(bytes);
+
+        return cooked;
+    }
+
+    std::shared_ptr<const CookedTexture> solid(const glm::u8vec4& color) {
+        auto cooked = std::make_shared<CookedTexture>();
+        cooked->format = GL_RGBA8;
+        cooked->compressed = false;
+        cooked->levels = {{1, 1, 0, 4}};
+        cooked->bytes = {color.r, color.g, color.b, color.a};
+        cooked->data = cooked->bytes.data();
+        cooked->size = cooked->bytes.size();
+
+        return cooked;
+    }
+
+}
@@ -0,0 +1,53 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <GL/glew.h>
+#include <QFile>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// How a source image is cooked
+enum class TextureUsage {
+    TEXTURE_COLOR,          // BC1, or BC3 if any texel is translucent
+    TEXTURE_COLOR_RAW,      // RGBA8, when S3TC is unavailable
+    TEXTURE_NORMAL          // BC5 xy, z is reconstructed in the shader
+};
+
+// Single mip level inside a cooked file
+struct CookedLevel {
+    uint32_t width;
+    uint32_t height;
+    uint32_t offset; // from start of level data
+    uint32_t size;   // bytes
+};
+
+// Cooked texture mapped read-only from the cache, levels point into the mapping
+struct CookedTexture {
+    GLenum format; // GL internal format of every level
+    bool compressed;
+    std::vector<CookedLevel> levels; // finest first
+
+    std::shared_ptr<QFile> file; // keeps the mapping alive
+    std::vector<uint8_t> bytes;  // owned file contents instead, when the cache is unwritable
+    const uint8_t* data = nullptr; // start of level data
+    size_t size = 0;               // bytes of level data
+};
+
+// On-disk cache of GPU-ready textures with full CPU built mip chains
+namespace TextureCache
+{
+    // Bump whenever the cooked layout or encoders change, stale files are simply never hit again
+    constexpr uint32_t VERSION = 1;
+
+    // Map the cooked file for filename, cooking and writing it first on a miss
+    // keyed by absolute path, size and mtime of the source, safe to call from worker threads
+    std::shared_ptr<const CookedTexture> load(const std::string& filename, TextureUsage usage);
+
+    // Uncompressed single texel held in memory, for placeholders
+    std::shared_ptr<const CookedTexture> solid(const glm::u8vec4& color);
+}
+
+#endif // TEXTURECACHE_H
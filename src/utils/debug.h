@@ -16,6 +16,11 @@ namespace Debug
     }
 }
 
+// glGetError waits on the driver, so release builds compile the checks out
+#ifdef NDEBUG
+#define glErrorCheck() ((void)0)
+#else
 #define glErrorCheck() glErrorCheck(__FILE__, __LINE__)
+#endif
 
 #endif // DEBUG_H
@@ -0,0 +1,50 @@
+#include "framegraph.h"
+#include <algorithm>
+#include <QPainter>
+
+FrameGraph::FrameGraph(QWidget *parent) :
+    QWidget(parent)
+{
+    setMinimumHeight(60);
+}
+
+void FrameGraph::addFrame(float ms) {
+    m_frames[m_next] = ms;
+    m_next = (m_next + 1) % HISTORY;
+    m_count = std::min(m_count + 1, HISTORY);
+}
+
+QSize FrameGraph::sizeHint() const {
+    return QSize{HISTORY, 80};
+}
+
+void FrameGraph::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor{32, 32, 32});
+
+    float scale = MIN_SCALE_MS;
+    for (int i = 0; i < m_count; ++i) scale = std::max(scale, m_frames[i]);
+
+    float barWidth = static_cast<float>(width()) / HISTORY;
+
+    // Oldest frame sits m_count bars from the right edge
+    for (int i = 0; i < m_count; ++i) {
+        float ms = m_frames[(m_next - m_count + i + HISTORY) % HISTORY];
+        float barHeight = ms / scale * height();
+
+        // Green within a 60 Hz frame, yellow within 30 Hz, red beyond
+        QColor color = ms <= 1000.f / 60.f ? QColor{80, 200, 120} :
+                       ms <= 1000.f / 30.f ? QColor{230, 200, 60} :
+                                             QColor{230, 70, 60};
+
+        float x = width() - (m_count - i) * barWidth;
+        painter.fillRect(QRectF{x, height() - barHeight, std::max(barWidth, 1.f), barHeight}, color);
+    }
+
+    // Budget lines of 60 and 30 Hz
+    painter.setPen(QColor{160, 160, 160});
+    for (float budget : {1000.f / 60.f, 1000.f / 30.f}) {
+        float y = height() - budget / scale * height();
+        painter.drawLine(QPointF{0.f, y}, QPointF{static_cast<qreal>(width()), y});
+    }
+}
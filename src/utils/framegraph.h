@@ -0,0 +1,32 @@
+#ifndef FRAMEGRAPH_H
+#define FRAMEGRAPH_H
+
+#include <array>
+#include <QWidget>
+
+// Bar graph of the most recent frame times, one bar per frame with the newest on the right
+class FrameGraph : public QWidget
+{
+public:
+    static constexpr int HISTORY = 180;
+
+    // frame time the graph is scaled to unless a spike needs more room
+    static constexpr float MIN_SCALE_MS = 1000.f / 30.f;
+
+    explicit FrameGraph(QWidget *parent = nullptr);
+
+    // append a frame, repainted on the next update()
+    void addFrame(float ms);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    std::array<float, HISTORY> m_frames{};
+    int m_next = 0;  // slot the next frame is written to
+    int m_count = 0; // frames held, at most HISTORY
+};
+
+#endif // FRAMEGRAPH_H
@@ -0,0 +1,191 @@
+#include "framewriter.h"
+#include <QImage>
+#include <QString>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include "profiler.h"
+#include "threadpool.h"
+#include "stats.h"
+
+FrameWriter::FrameWriter(const std::string& path, Format format, int fps, bool dropFrames) :
+    m_state(std::make_shared<State>()),
+    m_dropFrames(dropFrames)
+{
+    m_state->path = path;
+    m_state->format = format;
+    m_state->fps = fps;
+
+    if (format == Format::FORMAT_Y4M) {
+        m_state->file.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_state->file) throw std::runtime_error("Failed to open capture file: " + path);
+    }
+}
+
+FrameWriter::~FrameWriter() {
+    finish();
+}
+
+bool FrameWriter::write(const unsigned char* pixels, int width, int height) {
+    if (!m_state) return false;
+
+    if (m_nextIndex == 0) {
+        m_width = width;
+        m_height = height;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock{m_state->mutex};
+
+        if (!m_dropFrames) m_state->idle.wait(lock, [this]() { return m_state->pending < MAX_PENDING; });
+
+        // Y4M has one frame size for the whole stream
+        bool resized = m_state->format == Format::FORMAT_Y4M && (width != m_width || height != m_height);
+
+        if (m_state->pending >= MAX_PENDING || resized) {
+            stats.framesDropped++;
+            return false;
+        }
+
+        m_state->pending++;
+    }
+
+    int index = m_nextIndex++;
+    stats.framesCaptured++;
+
+    // Copy out of the mapped buffer here, everything after runs on the pool
+    std::vector<unsigned char> copy(pixels, pixels + static_cast<size_t>(width) * height * 4);
+
+    ThreadPool::instance().submit([state = m_state, index, width, height, copy = std::move(copy)]() mutable {
+        PROFILE_ZONE("FrameWriter::encode");
+
+        bool failed = false;
+        try {
+            if (state->format == Format::FORMAT_PNG) encodePng(*state, index, copy, width, height);
+            else encodeY4m(*state, index, copy, width, height);
+        } catch (std::exception& e) {
+            std::cerr << "Exception: " << e.what() << ", dropping frame " << index << std::endl;
+            failed = true;
+        }
+
+        std::lock_guard<std::mutex> lock{state->mutex};
+        if (failed) {
+            stats.framesDropped++;
+            // A placeholder keeps the frames queued behind this one flowing to the file,
+            // the first one still has to carry the stream header
+            if (state->format == Format::FORMAT_Y4M) {
+                std::string header = index == 0 ? streamHeader(*state, width, height) : "";
+                appendY4m(*state, index, std::vector<unsigned char>(header.begin(), header.end()));
+            }
+        }
+        state->pending--;
+        state->idle.notify_all();
+    });
+
+    return true;
+}
+
+void FrameWriter::finish() {
+    if (!m_state) return;
+
+    std::unique_lock<std::mutex> lock{m_state->mutex};
+    m_state->idle.wait(lock, [this]() { return m_state->pending == 0; });
+
+    if (m_state->file.is_open()) m_state->file.flush();
+}
+
+FrameWriter::Format FrameWriter::getFormat(const std::string& path) {
+    return path.ends_with(".y4m") ? Format::FORMAT_Y4M : Format::FORMAT_PNG;
+}
+
+void FrameWriter::encodePng(State& state, int index, std::vector<unsigned char>& pixels, int width, int height) {
+    // Number frames after the base name, keeping any directory and dropping the extension
+    std::string base = state.path;
+    size_t dot = base.find_last_of('.');
+    if (dot != std::string::npos && dot > base.find_last_of("/\\") + 1) base.erase(dot);
+
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%05d.png", index);
+
+    // GL rows start at the bottom, alpha is dropped since the shader output is not meant for compositing
+    QImage image(pixels.data(), width, height, QImage::Format_RGBA8888);
+    QImage flippedImage = image.flipped(Qt::Vertical).convertToFormat(QImage::Format_RGB888);
+
+    if (!flippedImage.save(QString::fromStdString(base + suffix))) {
+        std::cerr << "Failed to save image to " << base + suffix << std::endl;
+    }
+}
+
+std::string FrameWriter::streamHeader(const State& state, int width, int height) {
+    return "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) +
+           " F" + std::to_string(state.fps) + ":1 Ip A1:1 C420jpeg\n";
+}
+
+void FrameWriter::encodeY4m(State& state, int index, std::vector<unsigned char>& pixels, int width, int height) {
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+
+    std::string header = "FRAME\n";
+    if (index == 0) header = streamHeader(state, width, height) + header;
+
+    std::vector<unsigned char> frame(header.size() + width * height + 2 * chromaWidth * chromaHeight);
+    std::copy(header.begin(), header.end(), frame.begin());
+
+    unsigned char* yPlane = frame.data() + header.size();
+    unsigned char* uPlane = yPlane + width * height;
+    unsigned char* vPlane = uPlane + chromaWidth * chromaHeight;
+
+    auto clampByte = [](float v) { return static_cast<unsigned char>(std::min(std::max(v + 0.5f, 0.f), 255.f)); };
+
+    // BT.601 luma per pixel, flipping rows since GL starts at the bottom
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = &pixels[static_cast<size_t>(height - 1 - y) * width * 4];
+
+        for (int x = 0; x < width; ++x) {
+            const unsigned char* p = row + x * 4;
+            yPlane[y * width + x] = clampByte(0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2]);
+        }
+    }
+
+    // Chroma from the average of each 2x2 block, edge blocks reuse the last row or column
+    for (int cy = 0; cy < chromaHeight; ++cy) {
+        int y0 = height - 1 - 2 * cy;
+        int y1 = std::max(y0 - 1, 0);
+
+        for (int cx = 0; cx < chromaWidth; ++cx) {
+            int x0 = 2 * cx;
+            int x1 = std::min(x0 + 1, width - 1);
+
+            float r = 0.f, g = 0.f, b = 0.f;
+            for (int sy : {y0, y1}) {
+                for (int sx : {x0, x1}) {
+                    const unsigned char* p = &pixels[(static_cast<size_t>(sy) * width + sx) * 4];
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            }
+
+            r *= 0.25f;
+            g *= 0.25f;
+            b *= 0.25f;
+
+            uPlane[cy * chromaWidth + cx] = clampByte(128.f - 0.168736f * r - 0.331264f * g + 0.5f * b);
+            vPlane[cy * chromaWidth + cx] = clampByte(128.f + 0.5f * r - 0.418688f * g - 0.081312f * b);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock{state.mutex};
+    appendY4m(state, index, std::move(frame));
+}
+
+void FrameWriter::appendY4m(State& state, int index, std::vector<unsigned char> frame) {
+    state.encoded[index] = std::move(frame);
+
+    // Whichever task completes the next frame in order appends every frame ready behind it
+    for (auto it = state.encoded.begin(); it != state.encoded.end() && it->first == state.nextWrite;
+         it = state.encoded.erase(it), state.nextWrite++) {
+        state.file.write(reinterpret_cast<const char*>(it->second.data()), it->second.size());
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Encodes captured frames on the thread pool, as a numbered PNG sequence or a raw Y4M video
+class FrameWriter
+{
+public:
+    enum class Format { FORMAT_PNG, FORMAT_Y4M };
+
+    // frames waiting to be encoded beyond this are dropped or waited on instead of growing memory without bound
+    static constexpr int MAX_PENDING = 32;
+
+    FrameWriter() {}
+
+    // PNG frames are numbered after the base name of path, Y4M frames are appended to path itself
+    // live captures drop frames when encoding falls behind, offline ones wait so none go missing
+    FrameWriter(const std::string& path, Format format, int fps, bool dropFrames);
+
+    ~FrameWriter();
+
+    // copy bottom-up RGBA rows and encode them in the background, false if the frame was dropped
+    bool write(const unsigned char* pixels, int width, int height);
+
+    // block until every accepted frame is on disk
+    void finish();
+
+    // Y4M for a .y4m extension, PNG otherwise
+    static Format getFormat(const std::string& path);
+
+private:
+    // shared with encode tasks
+    struct State {
+        std::string path;
+        Format format;
+        int fps;
+
+        std::mutex mutex;
+        std::condition_variable idle;
+        int pending = 0; // frames accepted but not yet written
+
+        // Y4M frames finish encoding out of order but must be appended in order
+        std::ofstream file;
+        std::map<int, std::vector<unsigned char>> encoded;
+        int nextWrite = 0;
+    };
+
+    std::shared_ptr<State> m_state;
+    bool m_dropFrames = true;
+    int m_nextIndex = 0; // index of the next accepted frame
+    int m_width = 0;     // size of the first frame, every Y4M frame must match it
+    int m_height = 0;
+
+    static void encodePng(State& state, int index, std::vector<unsigned char>& pixels, int width, int height);
+    static void encodeY4m(State& state, int index, std::vector<unsigned char>& pixels, int width, int height);
+    // goes in front of the first Y4M frame, in full range 4:2:0
+    static std::string streamHeader(const State& state, int width, int height);
+    // queue an encoded frame and write every frame now in order, state.mutex must be held
+    static void appendY4m(State& state, int index, std::vector<unsigned char> frame);
+};
+
+#endif // FRAMEWRITER_H
@@ -0,0 +1,135 @@
+#include "gpuprofiler.h"
+#include <array>
+#include <vector>
+#include "stats.h"
+
+namespace
+{
+    // queries are allocated in blocks as zones per frame grow
+    constexpr size_t QUERY_BLOCK = 64;
+
+    struct GpuZone {
+        const char* name;
+        GLuint begin; // timestamp queries
+        GLuint end;
+    };
+
+    struct FrameSlot {
+        std::vector<GLuint> queries; // pool, two per zone
+        std::vector<GpuZone> zones;
+        GLuint last = 0;             // most recently issued query, results arrive in order so it finishes last
+        bool pending = false;        // closed but not yet reported
+    };
+
+    struct State {
+        std::array<FrameSlot, GpuProfiler::FRAME_LATENCY> slots;
+        int current = -1;               // slot being recorded, -1 before the first frame
+        int frames = 0;
+        int64_t offset = 0;             // CPU minus GPU clock in ns
+        Profiler::Track* track = nullptr;
+    };
+
+    State& state() {
+        static State instance;
+        return instance;
+    }
+
+    // GL_TIMESTAMP reads the GPU clock once commands reach the server, without waiting for them to execute
+    void calibrate(State& s) {
+        GLint64 gpuTime = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+        s.offset = Profiler::now() - gpuTime;
+    }
+
+    // report the zones of a closed slot, false if its queries are still in flight
+    bool resolve(State& s, FrameSlot& slot) {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(slot.last, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+
+        for (const GpuZone& zone : slot.zones) {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(zone.begin, GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(zone.end, GL_QUERY_RESULT, &end);
+
+            Profiler::record(s.track, zone.name, begin + s.offset, end + s.offset);
+        }
+
+        slot.pending = false;
+        return true;
+    }
+}
+
+void GpuProfiler::beginFrame() {
+    State& s = state();
+
+    if (!s.track) {
+        s.track = Profiler::addTrack("GPU");
+        calibrate(s);
+    }
+
+    if (s.current >= 0) s.slots[s.current].pending = !s.slots[s.current].zones.empty();
+
+    // Report oldest first, a frame still in flight means every later one is too
+    for (int k = 1; k <= FRAME_LATENCY; ++k) {
+        FrameSlot& slot = s.slots[(s.current + k + FRAME_LATENCY) % FRAME_LATENCY];
+        if (slot.pending && !resolve(s, slot)) break;
+    }
+
+    s.current = (s.current + 1) % FRAME_LATENCY;
+    FrameSlot& next = s.slots[s.current];
+
+    // GPU is more than FRAME_LATENCY frames behind, lose those timings rather than wait for them
+    if (next.pending) {
+        stats.gpuFramesDropped++;
+        next.pending = false;
+    }
+
+    next.zones.clear();
+
+    // Clocks drift apart slowly, resync now and then
+    if (++s.frames % CALIBRATION_FRAMES == 0) calibrate(s);
+}
+
+void GpuProfiler::clean() {
+    State& s = state();
+
+    for (FrameSlot& slot : s.slots) {
+        glDeleteQueries(slot.queries.size(), slot.queries.data());
+        slot = FrameSlot{};
+    }
+
+    s.current = -1;
+}
+
+GpuProfiler::Zone::Zone(const char* name) {
+    State& s = state();
+    if (s.current < 0) return;
+
+    FrameSlot& slot = s.slots[s.current];
+
+    if (slot.zones.size() * 2 + 2 > slot.queries.size()) {
+        size_t size = slot.queries.size();
+        slot.queries.resize(size + QUERY_BLOCK);
+        glGenQueries(QUERY_BLOCK, slot.queries.data() + size);
+    }
+
+    GpuZone zone{name, slot.queries[slot.zones.size() * 2], slot.queries[slot.zones.size() * 2 + 1]};
+
+    glQueryCounter(zone.begin, GL_TIMESTAMP);
+    slot.last = zone.begin;
+
+    m_slot = s.current;
+    m_index = slot.zones.size();
+    slot.zones.push_back(zone);
+}
+
+GpuProfiler::Zone::~Zone() {
+    if (m_slot < 0) return;
+
+    // Zones close before the next frame begins, so the slot is still the one being recorded
+    FrameSlot& slot = state().slots[m_slot];
+
+    glQueryCounter(slot.zones[m_index].end, GL_TIMESTAMP);
+    slot.last = slot.zones[m_index].end;
+}
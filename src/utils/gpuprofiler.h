@@ -0,0 +1,47 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <GL/glew.h>
+#include "profiler.h"
+
+// GPU zones timed with timestamp queries and reported through the CPU profiler on a "GPU" track
+// results are read a few frames late once available, so timing never waits on the GPU
+namespace GpuProfiler
+{
+    // frames of queries in flight, results not ready by the time their slot is reused are dropped
+    constexpr int FRAME_LATENCY = 4;
+
+    // frames between resyncs of the GPU clock to the CPU one
+    constexpr int CALIBRATION_FRAMES = 120;
+
+    // collect finished frames and start recording the next, needs a current context
+    void beginFrame();
+
+    // delete the queries of the current context
+    void clean();
+
+    // Times the GPU commands issued in its scope, name must be a string literal
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name);
+        ~Zone();
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        int m_slot = -1; // frame slot the zone began in, -1 if not recording
+        int m_index = 0; // zone within the slot
+    };
+}
+
+#ifdef PROFILER_ENABLED
+#define GPU_ZONE(name) GpuProfiler::Zone PROFILE_CONCAT(gpuZone, __LINE__){"GPU " name}
+#define GPU_FRAME() GpuProfiler::beginFrame()
+#else
+#define GPU_ZONE(name) ((void)0)
+#define GPU_FRAME() ((void)0)
+#endif
+
+#endif // GPUPROFILER_H
@@ -0,0 +1,19 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+// 64-bit FNV-1a, stable across runs and platforms unlike std::hash, used to name cache files
+inline uint64_t hashString(std::string_view key) {
+    uint64_t hash = 14695981039346656037ull;
+
+    for (char c : key) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+#endif // HASH_H
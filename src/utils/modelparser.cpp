@@ -4,6 +4,8 @@
 #include <iostream>
 #include <stdexcept>
 #include "modelparser.h"
+#include "geometry/indexoptimizer.h"
+#include "geometry/simplifier.h"
 
 namespace fs = std::filesystem;
 
@@ -208,6 +210,33 @@ namespace ModelParser {
         
     }
 
+    // Reorder one index list for the vertex cache, then for overdraw within cache-cold boundaries
+    static void optimizeIndexes(std::vector<unsigned int>& indexes, const std::vector<Vertex>& vertices) {
+        std::vector<size_t> clusters;
+
+        IndexOptimizer::optimizeVertexCache(indexes, vertices.size(), clusters);
+        IndexOptimizer::optimizeOverdraw(indexes, vertices, clusters);
+    }
+
+    static void optimizeMesh(RenderShapeData& shape) {
+        IndexOptimizer::CacheStats before = IndexOptimizer::analyze(shape.indexes, shape.vertexData.size());
+
+        optimizeIndexes(shape.indexes, shape.vertexData);
+
+        shape.lodIndexes = Simplifier::buildLods(shape.vertexData, shape.indexes, MAX_LODS);
+        for (auto& lod : shape.lodIndexes) optimizeIndexes(lod, shape.vertexData);
+
+        // Renumber vertices last, triangle order decides fetch order
+        IndexOptimizer::optimizeVertexFetch(shape.vertexData, shape.indexes, shape.lodIndexes);
+
+        IndexOptimizer::CacheStats after = IndexOptimizer::analyze(shape.indexes, shape.vertexData.size());
+
+        std::cout << "Optimized mesh " << shape.id << " of \"" << shape.primitive.meshfile << "\": "
+                  << "ACMR " << before.acmr << " -> " << after.acmr << ", "
+                  << "ATVR " << before.atvr << " -> " << after.atvr << ", "
+                  << shape.lodIndexes.size() + 1 << " LODs" << std::endl;
+    }
+
     void buildMeshData(RenderData& renderData,
                        const ScenePrimitive* primitive,
                        glm::mat4 ctm,
@@ -338,6 +367,10 @@ namespace ModelParser {
                 }
             }
 
+            // // BUILD LODS + OPTIMIZE
+            // NOTE: after bones so weight seams are known and weights follow reordered vertices
+            optimizeMesh(shape);
+
             renderData.shapes.push_back(shape);
         }
     }
@@ -0,0 +1,262 @@
+#include "profiler.h"
+
+#include <iomanip>
+
+void Profiler::printSummary(std::ostream& out) {
+    std::vector<ZoneStats> zones = summarize();
+    if (zones.empty()) return;
+
+    // Restore the stream's formatting afterwards
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << "Zone timings over the last " << ROLLING_FRAMES << " frames in ms (p50 / p95 / p99):" << std::endl;
+
+    for (const ZoneStats& zone : zones) {
+        out << "  " << std::left << std::setw(32) << zone.name << std::right << std::fixed << std::setprecision(3)
+            << zone.p50 << " / " << zone.p95 << " / " << zone.p99 << "  x" << zone.count << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+#ifdef PROFILER_ENABLED
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace
+{
+    // fields are atomic so exporting while a thread records is not a data race, relaxed stores cost nothing extra
+    struct Event {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<int64_t> start{0};
+        std::atomic<int64_t> end{0};
+    };
+
+    struct EventCopy {
+        const char* name;
+        int64_t start;
+        int64_t end;
+    };
+}
+
+// Single writer ring, owned by the registry so events outlive their thread
+struct Profiler::Track {
+    std::array<Event, RING_SIZE> events;
+    std::atomic<uint64_t> head{0}; // events ever recorded
+    int id = 0;
+    std::string name;              // guarded by registry mutex
+    int64_t frameStart = 0;        // last frame marker of this thread
+};
+
+namespace
+{
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Profiler::Track>> rings;
+        int64_t origin = Profiler::now(); // trace timestamps are relative to this
+    };
+
+    // Leaked on purpose, pool workers may still record while statics are destroyed at exit
+    Registry& registry() {
+        static Registry* instance = new Registry;
+        return *instance;
+    }
+
+    Profiler::Track* registerTrack(const std::string& name) {
+        auto ring = std::make_shared<Profiler::Track>();
+        Registry& reg = registry();
+
+        std::lock_guard<std::mutex> lock{reg.mutex};
+        ring->id = reg.rings.size();
+        ring->name = name.empty() ? "Thread " + std::to_string(ring->id) : name;
+        reg.rings.push_back(ring);
+
+        return ring.get();
+    }
+
+    thread_local Profiler::Track* t_ring = nullptr;
+
+    Profiler::Track& getRing() {
+        // Registration is the only locked step, once per thread
+        if (!t_ring) t_ring = registerTrack("");
+        return *t_ring;
+    }
+
+    // copy the events of a ring that were not overwritten while copying
+    std::vector<EventCopy> snapshot(const Profiler::Track& ring) {
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        uint64_t first = head > Profiler::RING_SIZE ? head - Profiler::RING_SIZE : 0;
+
+        std::vector<EventCopy> events;
+        events.reserve(head - first);
+
+        for (uint64_t i = first; i < head; ++i) {
+            const Event& e = ring.events[i % Profiler::RING_SIZE];
+            events.push_back({e.name.load(std::memory_order_relaxed),
+                              e.start.load(std::memory_order_relaxed),
+                              e.end.load(std::memory_order_relaxed)});
+        }
+
+        // The writer may have lapped the oldest slots meanwhile, including the one it is filling now
+        uint64_t after = ring.head.load(std::memory_order_acquire);
+        uint64_t valid = after + 1 > Profiler::RING_SIZE ? after + 1 - Profiler::RING_SIZE : 0;
+        if (valid > first) events.erase(events.begin(), events.begin() + std::min<uint64_t>(valid - first, events.size()));
+
+        return events;
+    }
+
+    std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+}
+
+Profiler::Track* Profiler::addTrack(const std::string& name) {
+    return registerTrack(name);
+}
+
+void Profiler::record(const char* name, int64_t start, int64_t end) {
+    record(&getRing(), name, start, end);
+}
+
+void Profiler::record(Track* track, const char* name, int64_t start, int64_t end) {
+    Track& ring = *track;
+
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    Event& e = ring.events[head % RING_SIZE];
+
+    e.name.store(name, std::memory_order_relaxed);
+    e.start.store(start, std::memory_order_relaxed);
+    e.end.store(end, std::memory_order_relaxed);
+
+    // Publish after the fields so a reader that sees the new head sees the event
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    Track& ring = getRing();
+
+    std::lock_guard<std::mutex> lock{registry().mutex};
+    ring.name = name;
+}
+
+void Profiler::markFrame() {
+    Track& ring = getRing();
+    int64_t time = now();
+
+    if (ring.frameStart) record(FRAME_ZONE, ring.frameStart, time);
+    ring.frameStart = time;
+}
+
+std::vector<Profiler::ZoneStats> Profiler::summarize() {
+    std::vector<EventCopy> events;
+
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock{reg.mutex};
+
+        for (const auto& ring : reg.rings) {
+            std::vector<EventCopy> ringEvents = snapshot(*ring);
+            events.insert(events.end(), ringEvents.begin(), ringEvents.end());
+        }
+    }
+
+    // Window opens at the start of the oldest of the last ROLLING_FRAMES frames
+    std::vector<int64_t> frameStarts;
+    for (const EventCopy& e : events) {
+        if (std::string_view{e.name} == FRAME_ZONE) frameStarts.push_back(e.start);
+    }
+
+    int64_t windowStart = 0;
+    if (frameStarts.size() > ROLLING_FRAMES) {
+        std::nth_element(frameStarts.begin(), frameStarts.end() - ROLLING_FRAMES, frameStarts.end());
+        windowStart = *(frameStarts.end() - ROLLING_FRAMES);
+    }
+
+    // Same literal may have different addresses across translation units, so group by text
+    std::map<std::string, std::vector<float>> durations;
+    for (const EventCopy& e : events) {
+        if (e.start >= windowStart) durations[e.name].push_back((e.end - e.start) * 1e-6f);
+    }
+
+    std::vector<ZoneStats> zones;
+
+    for (auto& [name, ms] : durations) {
+        std::sort(ms.begin(), ms.end());
+        auto percentile = [&ms](float fraction) { return ms[static_cast<size_t>(fraction * (ms.size() - 1) + 0.5f)]; };
+
+        zones.push_back({name, static_cast<int>(ms.size()), percentile(0.5f), percentile(0.95f), percentile(0.99f)});
+    }
+
+    std::sort(zones.begin(), zones.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.p95 > b.p95; });
+
+    return zones;
+}
+
+bool Profiler::writeTrace(const std::string& filepath) {
+    std::ofstream file(filepath, std::ios::trunc);
+    if (!file) return false;
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    auto separate = [&]() { if (!first) file << ",\n"; first = false; };
+
+    for (const auto& ring : reg.rings) {
+        separate();
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->id
+             << ",\"args\":{\"name\":\"" << escape(ring->name) << "\"}}";
+
+        // Complete events in microseconds, nesting is recovered from the timestamps
+        for (const EventCopy& e : snapshot(*ring)) {
+            separate();
+            file << "{\"name\":\"" << escape(e.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->id
+                 << ",\"ts\":" << (e.start - reg.origin) / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0 << "}";
+        }
+    }
+
+    file << "]}\n";
+
+    return static_cast<bool>(file);
+}
+
+#else
+
+Profiler::Track* Profiler::addTrack(const std::string&) {
+    return nullptr;
+}
+
+void Profiler::record(const char*, int64_t, int64_t) {}
+
+void Profiler::record(Track*, const char*, int64_t, int64_t) {}
+
+void Profiler::setThreadName(const std::string&) {}
+
+void Profiler::markFrame() {}
+
+std::vector<Profiler::ZoneStats> Profiler::summarize() {
+    return {};
+}
+
+bool Profiler::writeTrace(const std::string&) {
+    return false;
+}
+
+#endif
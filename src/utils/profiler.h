@@ -0,0 +1,90 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Scoped CPU zones recorded per thread, summarized as rolling percentiles or exported as Chrome trace JSON
+// zones only exist when PROFILER_ENABLED is defined, otherwise the macros expand to nothing
+namespace Profiler
+{
+    // events kept per thread, the oldest are overwritten
+    constexpr size_t RING_SIZE = 1 << 14;
+
+    // frames covered by the rolling percentiles
+    constexpr int ROLLING_FRAMES = 120;
+
+    // name of the zone spanning each frame marker to the next
+    constexpr const char* FRAME_ZONE = "Frame";
+
+    // durations in ms over the last ROLLING_FRAMES frames
+    struct ZoneStats {
+        std::string name;
+        int count;
+        float p50;
+        float p95;
+        float p99;
+    };
+
+    inline int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // ring of events written by a single thread
+    struct Track;
+
+    // track not bound to a thread, for timings measured elsewhere such as on the GPU
+    // only one thread may record to it, null when compiled out
+    Track* addTrack(const std::string& name);
+
+    // append a finished zone to the calling thread's ring, never locks after the thread's first event
+    void record(const char* name, int64_t start, int64_t end);
+
+    void record(Track* track, const char* name, int64_t start, int64_t end);
+
+    void setThreadName(const std::string& name);
+
+    // close the frame zone of the calling thread and open the next one
+    void markFrame();
+
+    // slowest zones first by p95, empty when compiled out
+    std::vector<ZoneStats> summarize();
+
+    // one line per zone of summarize
+    void printSummary(std::ostream& out);
+
+    // every event still in the rings, false when compiled out or the file cannot be written
+    bool writeTrace(const std::string& filepath);
+
+    // Times its scope, name must outlive the profiler so string literals only
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name) : m_name(name), m_start(now()) {}
+        ~Zone() { record(m_name, m_start, now()); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* m_name;
+        int64_t m_start;
+    };
+}
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__){name}
+#define PROFILE_FRAME() Profiler::markFrame()
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,136 @@
+#include "programcache.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstdio>
+#include <cstring>
+#include "hash.h"
+
+namespace
+{
+    constexpr char MAGIC[4] = {'P', 'B', 'I', 'N'};
+
+    // Fixed layout at the start of every cached file, followed by the full key and then the driver's binary
+    // files are named by a hash of the key, so the stored key rules out collisions feeding in another program
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t format;  // driver specific binary format
+        uint32_t keySize; // bytes of key
+        uint32_t size;    // bytes of binary
+    };
+
+    // Drivers that expose no binary formats cannot round trip programs at all
+    bool isSupported() {
+        GLint numFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+        return numFormats > 0;
+    }
+
+    std::string getString(GLenum name) {
+        const GLubyte* str = glGetString(name);
+        return str ? reinterpret_cast<const char*>(str) : "";
+    }
+
+    QString cachePath(const std::string& key) {
+        QDir dir{QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/shaders"};
+        dir.mkpath(".");
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hashString(key)));
+
+        return dir.filePath(QString(name));
+    }
+}
+
+namespace ProgramCache
+{
+
+    std::string makeKey(const std::vector<std::string>& sources) {
+        // Binaries are only valid for the exact driver that produced them
+        std::string key = getString(GL_VENDOR) + '|' + getString(GL_RENDERER) + '|' + getString(GL_VERSION) + '|' +
+                          std::to_string(VERSION);
+
+        for (const std::string& source : sources) {
+            key += '\0';
+            key += source;
+        }
+
+        return key;
+    }
+
+    GLuint load(const std::string& key) {
+        if (!isSupported()) return 0;
+
+        QString path = cachePath(key);
+        QFile file{path};
+        if (!file.open(QIODevice::ReadOnly)) return 0;
+
+        QByteArray bytes = file.readAll();
+        file.close();
+
+        FileHeader header;
+        if (static_cast<size_t>(bytes.size()) < sizeof(FileHeader)) return 0;
+        std::memcpy(&header, bytes.constData(), sizeof(FileHeader));
+
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+            sizeof(FileHeader) + static_cast<size_t>(header.keySize) + header.size != static_cast<size_t>(bytes.size())) {
+            QFile::remove(path);
+            return 0;
+        }
+
+        // Same hash but a different program, treated like any other stale entry
+        const char* storedKey = bytes.constData() + sizeof(FileHeader);
+
+        if (header.keySize != key.size() || std::memcmp(storedKey, key.data(), key.size()) != 0) {
+            QFile::remove(path);
+            return 0;
+        }
+
+        GLuint programID = glCreateProgram();
+        glProgramBinary(programID, header.format, storedKey + header.keySize, header.size);
+
+        // Drivers may still reject a binary whose key matched, e.g. after an update that kept its version string
+        GLint status;
+        glGetProgramiv(programID, GL_LINK_STATUS, &status);
+
+        if (status == GL_FALSE) {
+            glDeleteProgram(programID);
+            QFile::remove(path);
+            return 0;
+        }
+
+        return programID;
+    }
+
+    void store(const std::string& key, GLuint program) {
+        if (!isSupported()) return;
+
+        GLint size = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+        if (size <= 0) return;
+
+        size_t binaryOffset = sizeof(FileHeader) + key.size();
+
+        std::vector<char> bytes(binaryOffset + size);
+        GLenum format;
+        GLsizei length = 0;
+        glGetProgramBinary(program, size, &length, &format, bytes.data() + binaryOffset);
+
+        FileHeader header{{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]}, VERSION, format,
+                          static_cast<uint32_t>(key.size()), static_cast<uint32_t>(length)};
+        std::memcpy(bytes.data(), &header, sizeof(FileHeader));
+        std::memcpy(bytes.data() + sizeof(FileHeader), key.data(), key.size());
+        bytes.resize(binaryOffset + length);
+
+        // Written to a temp file and renamed on commit, so readers never see a partial binary
+        QSaveFile file{cachePath(key)};
+        if (!file.open(QIODevice::WriteOnly)) return;
+
+        file.write(bytes.data(), bytes.size());
+        file.commit();
+    }
+
+}
@@ -0,0 +1,25 @@
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries, so later launches skip compiling and linking
+namespace ProgramCache
+{
+    // Bump whenever the file layout changes, stale files are simply never hit again
+    constexpr uint32_t VERSION = 2;
+
+    // Key of a program linked from these stage sources by the driver of the current context
+    std::string makeKey(const std::vector<std::string>& sources);
+
+    // New program created from the cached binary, 0 on a miss or if the driver rejects it
+    GLuint load(const std::string& key);
+
+    // Save the binary of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT, skipped if unsupported
+    void store(const std::string& key, GLuint program);
+}
+
+#endif // PROGRAMCACHE_H
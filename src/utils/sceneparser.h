@@ -6,10 +6,9 @@
 #include <unordered_map>
 #include <glm/gtc/quaternion.hpp>
 
-#define MAX_LIGHTS 8
-#define MAX_BONES 128
 #define MAX_WEIGHTS 4
 #define MAX_PROJECTILES 5
+#define MAX_LODS 4
 
 // Struct which contains vertex data for indexed mesh rendering
 struct Vertex {
@@ -83,8 +82,10 @@ struct RenderShapeData {
     glm::mat3 ctmInv; // the 3x3 inverse of the cumulative transformation matrix
 
     int id; // mesh id
+    int materialIdx = 0; // index into scene material buffer
     std::vector<Vertex> vertexData; // mesh vertex data
     std::vector<unsigned int> indexes; // mesh indexes
+    std::vector<std::vector<unsigned int>> lodIndexes; // simplified mesh indexes, coarser each level
 };
 
 // Struct which contains all the data needed to render a scene
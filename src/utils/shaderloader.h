@@ -7,17 +7,58 @@
 #include <GL/glew.h>
 #include <QFile>
 #include <QTextStream>
+#include <chrono>
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "programcache.h"
+#include "stats.h"
 
 class ShaderLoader{
 public:
-    static GLuint createShaderProgram(const char * vertex_file_path, const char * fragment_file_path){
+    // Map of active uniform names to locations, filled once at link time
+    using UniformMap = std::unordered_map<std::string, GLint>;
+
+    // defines are injected into both stages, one "#define NAME" each
+    static GLuint createShaderProgram(const char * vertex_file_path,
+                                      const char * fragment_file_path,
+                                      UniformMap& uniforms,
+                                      const std::vector<std::string>& defines = {}){
+        auto start = std::chrono::steady_clock::now();
+
+        std::string vertexCode = readShader(vertex_file_path, defines);
+        std::string fragmentCode = readShader(fragment_file_path, defines);
+
+        // Reuse the binary linked by a previous launch if sources and driver are unchanged
+        std::string key = ProgramCache::makeKey({vertexCode, fragmentCode});
+        GLuint programID = ProgramCache::load(key);
+
+        if (programID) {
+            stats.programsCached++;
+        } else {
+            programID = linkProgram(vertexCode, fragmentCode);
+            ProgramCache::store(key, programID);
+            stats.programsCompiled++;
+        }
+
+        // Reflect active uniforms once so no lookups are needed per frame
+        uniforms = getActiveUniforms(programID);
+
+        stats.programMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        return programID;
+    }
+
+private:
+    static GLuint linkProgram(const std::string& vertexCode, const std::string& fragmentCode){
         // Create and compile the shaders.
-        GLuint vertexShaderID = createShader(GL_VERTEX_SHADER, vertex_file_path);
-        GLuint fragmentShaderID = createShader(GL_FRAGMENT_SHADER, fragment_file_path);
+        GLuint vertexShaderID = createShader(GL_VERTEX_SHADER, vertexCode);
+        GLuint fragmentShaderID = createShader(GL_FRAGMENT_SHADER, fragmentCode);
 
-        // Link the shader program.
+        // Link the shader program, keeping its binary retrievable for the program cache.
         GLuint programID = glCreateProgram();
+        glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         glAttachShader(programID, vertexShaderID);
         glAttachShader(programID, fragmentShaderID);
         glLinkProgram(programID);
@@ -44,10 +85,41 @@ public:
         return programID;
     }
 
-private:
-    static GLuint createShader(GLenum shaderType, const char *filepath){
-        GLuint shaderID = glCreateShader(shaderType);
+    static UniformMap getActiveUniforms(GLuint programID){
+        UniformMap uniforms;
+
+        GLint count, maxLength;
+        glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::string name(maxLength, '\0');
+
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length;
+            GLint size;
+            GLenum type;
+            glGetActiveUniform(programID, i, maxLength, &length, &size, &type, &name[0]);
 
+            // Skip members of uniform blocks, they are backed by buffers
+            GLint blockIndex;
+            GLuint index = i;
+            glGetActiveUniformsiv(programID, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+            if (blockIndex != -1) continue;
+
+            std::string uniformName = name.substr(0, length);
+
+            // Arrays of basic types are reported as "name[0]", store them under "name"
+            if (size > 1 && uniformName.ends_with("[0]")) {
+                uniformName.erase(uniformName.size() - 3);
+            }
+
+            uniforms[uniformName] = glGetUniformLocation(programID, uniformName.c_str());
+        }
+
+        return uniforms;
+    }
+
+    static std::string readShader(const char *filepath, const std::vector<std::string>& defines){
         // Read shader file.
         std::string code;
         QString filepathStr = QString(filepath);
@@ -59,6 +131,19 @@ private:
             throw std::runtime_error(std::string("Failed to open shader: ")+filepath);
         }
 
+        // Insert defines after #version, which must stay the first line
+        std::string header;
+        for (const std::string& define : defines) header += "#define " + define + "\n";
+
+        size_t lineEnd = code.find('\n');
+        code.insert(lineEnd == std::string::npos ? code.size() : lineEnd + 1, header);
+
+        return code;
+    }
+
+    static GLuint createShader(GLenum shaderType, const std::string& code){
+        GLuint shaderID = glCreateShader(shaderType);
+
         // Compile shader code.
         const char *codePtr = code.c_str();
         glShaderSource(shaderID, 1, &codePtr, nullptr); // Assumes code is null terminated
@@ -0,0 +1,56 @@
+#include "shadervariants.h"
+#include <algorithm>
+#include <iostream>
+#include "shaderloader.h"
+
+ShaderVariants::ShaderVariants(const std::string& vertPath, const std::string& fragPath) :
+    m_vertPath(vertPath),
+    m_fragPath(fragPath)
+{}
+
+const ShaderVariant& ShaderVariants::get(uint32_t features) {
+    auto it = m_variants.find(features);
+    if (it != m_variants.end()) return it->second;
+
+    std::vector<std::string> defines = UniLoader::getFeatureDefines(features);
+
+    ShaderLoader::UniformMap uniforms;
+    ShaderVariant variant;
+    variant.program = ShaderLoader::createShaderProgram(m_vertPath.c_str(), m_fragPath.c_str(), uniforms, defines);
+
+    try {
+        variant.uni = UniLoader::loadUniformTable(variant.program, uniforms, features);
+    } catch (...) {
+        glDeleteProgram(variant.program);
+        throw;
+    }
+
+    // Samplers read fixed slots, so they never change after link
+    glUseProgram(variant.program);
+    UniLoader::passSamplerVars(variant.uni);
+
+#ifndef NDEBUG
+    // Validation catches samplers of different types sharing a unit, which would fail every draw
+    glValidateProgram(variant.program);
+
+    GLint valid;
+    glGetProgramiv(variant.program, GL_VALIDATE_STATUS, &valid);
+
+    if (valid == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(variant.program, GL_INFO_LOG_LENGTH, &length);
+
+        std::string log(std::max(length, 1), '\0');
+        glGetProgramInfoLog(variant.program, length, nullptr, &log[0]);
+
+        std::cerr << "Shader variant " << features << " failed validation: " << log << std::endl;
+    }
+#endif
+
+    return m_variants.emplace(features, variant).first->second;
+}
+
+void ShaderVariants::clean() {
+    for (auto& [_, variant] : m_variants) glDeleteProgram(variant.program);
+    m_variants.clear();
+}
@@ -0,0 +1,36 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "uniloader.h"
+
+// Linked program of one feature combination and its uniform locations
+struct ShaderVariant {
+    GLuint program = 0;
+    UniLoader::UniformTable uni;
+};
+
+// Permutations of one vertex + fragment shader pair, keyed by ShaderFeature bits
+class ShaderVariants
+{
+public:
+    ShaderVariants() {}
+
+    ShaderVariants(const std::string& vertPath, const std::string& fragPath);
+
+    // program with exactly these features, compiled and linked on first request
+    const ShaderVariant& get(uint32_t features);
+
+    void clean();
+
+private:
+    std::string m_vertPath;
+    std::string m_fragPath;
+
+    std::unordered_map<uint32_t, ShaderVariant> m_variants;
+};
+
+#endif // SHADERVARIANTS_H
@@ -0,0 +1,54 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <cstddef>
+
+// Per-frame counters, written by the scene and read by the UI
+struct Stats {
+    // render queue
+    int drawCalls = 0;
+    int triangles = 0;         // submitted by every draw call, instances included
+    int textureBinds = 0;      // texture and buffer texture binds, including the light list and grid
+    int stateChanges = 0;      // texture, palette, VAO and program changes issued
+    int stateChangesSaved = 0; // changes avoided compared to drawing in scene-file order
+
+    // uploads
+    int uniformUploads = 0;  // uniform blocks, light buffers and sampler uniforms written
+    size_t bytesUploaded = 0; // uniform, light, palette, instance, texture and geometry data
+
+    // culling
+    int visibleShapes = 0;
+    int culledShapes = 0;
+    int occludedShapes = 0; // inside the frustum but hidden behind occluders
+
+    // clustered lighting
+    int lights = 0;
+    int lightIndexes = 0; // light references summed over every cluster
+
+    // physics, written every tick
+    int rigidBodies = 0;    // dynamic bodies not at rest
+    int collisionTests = 0; // candidate pairs run through narrow phase detection
+    int contacts = 0;       // pairs found touching
+
+    // animation, written every tick
+    float animatorMs = 0.f; // time spent evaluating every animator's palette
+
+    // shader programs, cumulative since launch
+    int programsCached = 0;   // created from a cached binary
+    int programsCompiled = 0; // compiled and linked from source
+    float programMs = 0.f;    // time spent creating either
+
+    // frame capture, cumulative since the capture started
+    int framesCaptured = 0; // handed to the writer
+    int framesDropped = 0;  // skipped because the writer fell too far behind or failed to encode
+    int captureStalls = 0;  // reads that waited on the GPU because every readback buffer was in flight
+
+    // GPU profiler, cumulative since launch
+    int gpuFramesDropped = 0; // frames whose timer queries were not ready before their slot was reused
+};
+
+
+// The global Stats object, reset by the scene every frame
+extern Stats stats;
+
+#endif // STATS_H
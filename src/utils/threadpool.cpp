@@ -0,0 +1,44 @@
+#include "threadpool.h"
+#include <algorithm>
+#include "profiler.h"
+
+ThreadPool::ThreadPool(int numThreads) {
+    for (int i = 0; i < numThreads; ++i) m_workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stop = true;
+    }
+
+    m_cv.notify_all();
+
+    // workers drain remaining tasks before exiting
+    for (std::thread& worker : m_workers) worker.join();
+}
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool{std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1)};
+    return pool;
+}
+
+void ThreadPool::work() {
+    PROFILE_THREAD("Worker");
+
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+
+            if (m_stop && m_tasks.empty()) return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    ThreadPool(int numThreads);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // queue task on a worker, result is delivered through the returned future
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        using R = std::invoke_result_t<F>;
+
+        // packaged_task is move-only, std::function needs a copyable wrapper
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        std::future<R> result = packaged->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_tasks.emplace([packaged]() { (*packaged)(); });
+        }
+
+        m_cv.notify_one();
+
+        return result;
+    }
+
+    // shared pool for background work, one thread per core minus the render thread
+    static ThreadPool& instance();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+
+    void work();
+};
+
+#endif // THREADPOOL_H
@@ -1,209 +1,164 @@
 #include <stdexcept>
 #include <iostream>
+#include <vector>
+#include <algorithm>
 #include "uniloader.h"
+#include "stats.h"
 
 namespace UniLoader
 {
 
-    void passGlobalVars(GLuint shader, const SceneGlobalData& global) {
-        GLint ka = glGetUniformLocation(shader, "ka");
-        GLint kd = glGetUniformLocation(shader, "kd");
-        GLint ks = glGetUniformLocation(shader, "ks");
-
-        if (ka == -1 || kd == -1 || ks == -1) {
-            throw std::invalid_argument("Missing global uniform variables");
-        }
-
-        glUniform1f(ka, global.ka);
-        glUniform1f(kd, global.kd);
-        glUniform1f(ks, global.ks);
+    static GLint fetch(const std::unordered_map<std::string, GLint>& uniforms, const std::string& name) {
+        auto it = uniforms.find(name);
+        return it == uniforms.end() ? -1 : it->second;
     }
 
-
-    void passCamVars(GLuint shader, const Camera& cam) {
-        GLint view = glGetUniformLocation(shader, "view");
-        GLint proj = glGetUniformLocation(shader, "proj");
-        GLint camPos = glGetUniformLocation(shader, "camPos");
-
-        if (view == -1 || proj == -1 || camPos == -1) {
-            throw std::invalid_argument("Missing camera uniform variables");
-        }
-
-        glUniformMatrix4fv(view, 1, GL_FALSE, &cam.getView()[0][0]);
-        glUniformMatrix4fv(proj, 1, GL_FALSE, &cam.getProj()[0][0]);
-        glUniform3fv(camPos, 1, &cam.getPos()[0]);
+    // every write of uniform data passes through here for the stats panel
+    static void countUpload(size_t bytes, int uploads = 1) {
+        stats.uniformUploads += uploads;
+        stats.bytesUploaded += bytes;
     }
 
+    static void bindBlock(GLuint shader, const char* name, GLuint binding) {
+        GLuint index = glGetUniformBlockIndex(shader, name);
 
-    void passLightVars(GLuint shader, const SceneLightData& light, int idx, bool clean) {
-        std::string i = std::to_string(idx);
-
-        GLint type = glGetUniformLocation(shader, ("lights[" + i + "].type").c_str());
-
-        if (type == -1) {
-            throw std::invalid_argument("Missing light type uniform variable");
+        if (index == GL_INVALID_INDEX) {
+            std::cerr << "Missing uniform block name: " << name << std::endl;
+            throw std::invalid_argument("Missing uniform block");
         }
 
-        GLint color = glGetUniformLocation(shader, ("lights[" + i + "].color").c_str());
-        GLint function = glGetUniformLocation(shader, ("lights[" + i + "].function").c_str());
-
-        if (color == -1 || function == -1) {
-            throw std::invalid_argument("Missing light color and function uniform variables");
-        }
+        glUniformBlockBinding(shader, index, binding);
+    }
 
-        GLint pos = glGetUniformLocation(shader, ("lights[" + i + "].pos").c_str());
-        GLint dir = glGetUniformLocation(shader, ("lights[" + i + "].dir").c_str());
+    std::vector<std::string> getFeatureDefines(uint32_t features) {
+        // indexed like ShaderFeature
+        static const char* NAMES[NUM_SHADER_FEATURES] = {"NORMAL_MAP", "SKINNED", "DIR_LIGHTS", "POINT_LIGHTS", "SPOT_LIGHTS"};
 
-        if (pos == -1 || dir == -1) {
-            throw std::invalid_argument("Missing light pos and dir uniform variables");
+        std::vector<std::string> defines;
+        for (int i = 0; i < NUM_SHADER_FEATURES; ++i) {
+            if (features & (1u << i)) defines.push_back(NAMES[i]);
         }
 
-        GLint penumbra = glGetUniformLocation(shader, ("lights[" + i + "].penumbra").c_str());
-        GLint angle = glGetUniformLocation(shader, ("lights[" + i + "].angle").c_str());
-
-        if (penumbra == -1 || angle == -1) {
-            throw std::invalid_argument("Missing light penumbra and angle uniform variables");
-        }
+        return defines;
+    }
 
-        if (clean) {
-            glUniform1i(type, 0);
+    UniformTable loadUniformTable(GLuint shader, const std::unordered_map<std::string, GLint>& uniforms, uint32_t features) {
+        UniformTable uni;
 
-            glUniform4f(color, 0.f, 0.f, 0.f, 0.f);
-            glUniform3f(function, 0.f, 0.f, 0.f);
+        // attach uniform blocks to their binding points
+        bindBlock(shader, "Camera", CAMERA_BLOCK);
+        bindBlock(shader, "Globals", GLOBALS_BLOCK);
+        bindBlock(shader, "Materials", MATERIALS_BLOCK);
 
-            glUniform3f(pos, 0.f, 0.f, 0.f);
-            glUniform3f(dir, 0.f, 0.f, 0.f);
+        // texture vars, unused when the variant has no lights
+        uni.tex = fetch(uniforms, "tex");
+        uni.normTex = fetch(uniforms, "normTex");
 
-            glUniform1f(penumbra, 0.f);
-            glUniform1f(angle, 0.f);
+        // bone vars, every skinned variant reads the palette
+        uni.skinPalette = fetch(uniforms, "skinPalette");
 
-            return;
+        if ((features & featureBit(ShaderFeature::FEATURE_SKINNED)) && uni.skinPalette == -1) {
+            throw std::invalid_argument("Missing bone uniform variables");
         }
 
-        glUniform1i(type, static_cast<int>(light.type));
-
-        glUniform4fv(color, 1, &light.color[0]);
-        glUniform3fv(function, 1, &light.function[0]);
+        // light vars, only present for the light types the variant was compiled with
+        uni.lightData = fetch(uniforms, "lightData");
+        uni.lightCells = fetch(uniforms, "lightCells");
+        uni.lightIndexes = fetch(uniforms, "lightIndexes");
 
-        glUniform3fv(pos, 1, &light.pos[0]);
-        glUniform3fv(dir, 1, &light.dir[0]);
-
-        glUniform1f(penumbra, light.penumbra);
-        glUniform1f(angle, light.angle);
+        return uni;
     }
 
 
-    void passShapeVars(GLuint shader, const RenderShapeData& shape) {
-        GLint model = glGetUniformLocation(shader, "model");
-        GLint modelInvT = glGetUniformLocation(shader, "modelInvT");
-
-        if (model == -1 || modelInvT == -1) {
-            throw std::invalid_argument("Missing model matrix uniform variables");
-        }
+    void passGlobalBlock(const UniformBuffer& ubo, const SceneGlobalData& global, int numDirLights) {
+        GlobalBlock block{global.ka, global.kd, global.ks, numDirLights};
 
-        glUniformMatrix4fv(model, 1, GL_FALSE, &shape.ctm[0][0]);
-        glUniformMatrix3fv(modelInvT, 1, GL_TRUE, &shape.ctmInv[0][0]);
+        ubo.update(&block, sizeof(GlobalBlock));
+        countUpload(sizeof(GlobalBlock));
+    }
 
-        // pass material vars
-        GLint ambient = glGetUniformLocation(shader, "material.ambient");
-        GLint diffuse = glGetUniformLocation(shader, "material.diffuse");
-        GLint specular = glGetUniformLocation(shader, "material.specular");
-        GLint shininess = glGetUniformLocation(shader, "material.shininess");
 
-        if (ambient == -1 || diffuse == -1 || specular == -1 || shininess == -1) {
-            throw std::invalid_argument("Missing material uniform variables");
-        }
+    void passCamBlock(const UniformBuffer& ubo, const Camera& cam, const LightGrid& grid) {
+        CameraBlock block{cam.getView(), cam.getProj(), glm::vec4{cam.getPos(), 1.f},
+                          glm::vec4{cam.getNear(), cam.getFar(), grid.getSliceScale(), 0.f}};
 
-        glUniform4fv(ambient, 1, &shape.primitive.material.cAmbient[0]);
-        glUniform4fv(diffuse, 1, &shape.primitive.material.cDiffuse[0]);
-        glUniform4fv(specular, 1, &shape.primitive.material.cSpecular[0]);
-        glUniform1f(shininess, shape.primitive.material.shininess);
+        ubo.update(&block, sizeof(CameraBlock));
+        countUpload(sizeof(CameraBlock));
+    }
 
-        // pass texture-related vars
-        GLint blend = glGetUniformLocation(shader, "material.blend");
-        GLint repeatU = glGetUniformLocation(shader, "repeatU");
-        GLint repeatV = glGetUniformLocation(shader, "repeatV");
 
-        if (blend == -1 || repeatU == -1 || repeatV == -1) {
-            throw std::invalid_argument("Missing texture-related material uniform variables");
-        }
+    void passLightData(TextureBuffer& tbo, const std::vector<SceneLightData>& lights) {
+        // never empty, a buffer texture without storage is not safe to bind
+        std::vector<LightBlock> blocks(std::max<size_t>(lights.size(), 1));
+        blocks[0].type = -1.f;
 
-        glUniform1f(blend, shape.primitive.material.blend);
-        glUniform1f(repeatU, shape.primitive.material.textureMap.repeatU);
-        glUniform1f(repeatV, shape.primitive.material.textureMap.repeatV);
+        for (int i = 0; i < lights.size(); ++i) {
+            const SceneLightData& light = lights[i];
 
-        // pass bone bool as false
-        GLint hasBonesID = glGetUniformLocation(shader, "hasBones");
-
-        if (hasBonesID == -1) {
-            throw std::invalid_argument("Missing bone boolean uniform variable");
+            blocks[i] = LightBlock{
+                light.color,
+                light.function,
+                static_cast<float>(light.type),
+                glm::vec3{light.pos},
+                light.penumbra,
+                glm::vec3{light.dir},
+                light.angle
+            };
         }
 
-        glUniform1i(hasBonesID, false);
+        tbo.update(blocks.data(), blocks.size() * sizeof(LightBlock));
+        countUpload(blocks.size() * sizeof(LightBlock));
     }
 
-    void passTextureVars(GLuint shader, const Texture& texture) {
-        // pass normal map bool
-        GLint hasNormMapID = glGetUniformLocation(shader, "hasNormMap");
-
-        if (hasNormMapID == -1) {
-            throw std::invalid_argument("Missing normal map boolean uniform variable");
-        }
-
-        glUniform1i(hasNormMapID, texture.getSlot() == 1);
 
-        // pass texture sampler2D var
-        std::string var = texture.getSlot() == 1 ? "normTex" : "tex";
+    void passLightGrid(TextureBuffer& cells, TextureBuffer& indexes, const LightGrid& grid) {
+        cells.update(grid.getCells().data(), grid.getCells().size() * sizeof(glm::uvec2));
+        countUpload(grid.getCells().size() * sizeof(glm::uvec2));
 
-        GLint texID = glGetUniformLocation(shader, var.c_str());
+        // same as above, an empty grid still gets one unreferenced index
+        static const uint32_t NO_LIGHT = 0;
+        const std::vector<uint32_t>& list = grid.getIndexes();
 
-        if (texID == -1) {
-            std::cerr << "Missing texture var name: " << var << std::endl;
-            throw std::invalid_argument("Missing texture sampler2D uniform variable");
+        if (list.empty()) {
+            indexes.update(&NO_LIGHT, sizeof(uint32_t));
+            countUpload(sizeof(uint32_t));
+        } else {
+            indexes.update(list.data(), list.size() * sizeof(uint32_t));
+            countUpload(list.size() * sizeof(uint32_t));
         }
-
-        glUniform1i(texID, texture.getSlot());
     }
 
-    void passBoneVars(GLuint shader, const Animator& animator) {
-        const auto& skinMats = animator.getSkinMats();
-
-        // pass bone bool as true if skinning matrices exist
-        if (!skinMats.empty()) {
-            GLint hasBonesID = glGetUniformLocation(shader, "hasBones");
-
-            if (hasBonesID == -1) {
-                throw std::invalid_argument("Missing bone boolean uniform variable");
-            }
-
-            glUniform1i(hasBonesID, true);
-        }
 
-        for (int i = 0; i < skinMats.size(); ++i) {
-            if (i >= MAX_BONES) break;
+    MaterialBlock getMaterialBlock(const SceneMaterial& material) {
+        return MaterialBlock{
+            material.cAmbient,
+            material.cDiffuse,
+            material.cSpecular,
+            material.shininess,
+            material.blend,
+            material.textureMap.repeatU,
+            material.textureMap.repeatV
+        };
+    }
 
-            const glm::mat4& skinMat = skinMats[i];
-            
-            GLint skinMatID = glGetUniformLocation(shader, ("skinMats[" + std::to_string(i) + "]").c_str());
-            if (skinMatID != -1) glUniformMatrix4fv(skinMatID, 1, GL_FALSE, &skinMat[0][0]);
 
-            GLint skinMatT = glGetUniformLocation(shader, ("skinMatsT[" + std::to_string(i) + "]").c_str());
-            if (skinMatT != -1) glUniformMatrix3fv(skinMatT, 1, GL_TRUE, &glm::mat3{glm::inverse(skinMat)}[0][0]);
-        }
+    void passMaterialBlock(const UniformBuffer& ubo, const std::vector<MaterialBlock>& materials) {
+        ubo.update(materials.data(), materials.size() * sizeof(MaterialBlock));
+        countUpload(materials.size() * sizeof(MaterialBlock));
     }
 
-    void passPhysVars(GLuint shader, const RigidBody& rigidBody) {
-        GLint model = glGetUniformLocation(shader, "model");
-        GLint modelInvT = glGetUniformLocation(shader, "modelInvT");
-
-        if (model == -1 || modelInvT == -1) {
-            throw std::invalid_argument("Missing model matrix uniform variables");
-        }
 
-        glm::mat4 transform = rigidBody.getCtm();
+    void passSamplerVars(const UniformTable& uni) {
+        // samplers read fixed slots, so they are set once per program (location -1 is ignored)
+        // every sampler needs its own slot before the first draw, two sampler types left on unit 0 fail every draw
+        glUniform1i(uni.tex, 0);
+        glUniform1i(uni.normTex, 1);
+        glUniform1i(uni.skinPalette, PALETTE_SLOT);
+        glUniform1i(uni.lightData, LIGHT_DATA_SLOT);
+        glUniform1i(uni.lightCells, LIGHT_CELLS_SLOT);
+        glUniform1i(uni.lightIndexes, LIGHT_INDEXES_SLOT);
 
-        glUniformMatrix4fv(model, 1, GL_FALSE, &transform[0][0]);
-        glUniformMatrix3fv(modelInvT, 1, GL_TRUE, &glm::mat3{glm::inverse(transform)}[0][0]);
+        countUpload(6 * sizeof(GLint), 6);
     }
 
 }
@@ -2,27 +2,119 @@
 #define UNILOADER_H
 
 #include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "sceneparser.h"
 #include "camera/camera.h"
-#include "texture/texture.h"
-#include "animation/animator.h"
-#include "physics/rigidbody.h"
+#include "buffer/texturebuffer.h"
+#include "buffer/uniformbuffer.h"
+#include "scene/lightgrid.h"
 
 namespace UniLoader
 {
-    void passGlobalVars(GLuint shader, const SceneGlobalData& global);
+    // Uniform block binding points
+    constexpr GLuint CAMERA_BLOCK = 0;
+    constexpr GLuint GLOBALS_BLOCK = 1;
+    constexpr GLuint MATERIALS_BLOCK = 2;
 
-    void passCamVars(GLuint shader, const Camera& cam);
+    // Max number of unique materials in the Materials block (64 bytes each, 16KB min UBO size)
+    constexpr int MAX_MATERIALS = 256;
 
-    void passLightVars(GLuint shader, const SceneLightData& light, int idx, bool clean);
+    // Compile-time shader features, a variant is compiled with a #define per set bit
+    enum class ShaderFeature {
+        FEATURE_NORMAL_MAP,
+        FEATURE_SKINNED,
+        FEATURE_DIR_LIGHTS,
+        FEATURE_POINT_LIGHTS,
+        FEATURE_SPOT_LIGHTS
+    };
 
-    void passShapeVars(GLuint shader, const RenderShapeData& shape);
+    constexpr int NUM_SHADER_FEATURES = 5;
 
-    void passTextureVars(GLuint shader, const Texture& texture);
+    constexpr uint32_t featureBit(ShaderFeature feature) { return 1u << static_cast<int>(feature); }
 
-    void passBoneVars(GLuint shader, const Animator& animator);
+    // #define names of every set feature bit
+    std::vector<std::string> getFeatureDefines(uint32_t features);
 
-    void passPhysVars(GLuint shader, const RigidBody& rigidBody);
+    // Texture slot of the skinning palette (0 and 1 hold diffuse and normal maps)
+    constexpr unsigned int PALETTE_SLOT = 2;
+
+    // Texture slots of the light list and the cluster grid indexing into it
+    constexpr unsigned int LIGHT_DATA_SLOT = 3;
+    constexpr unsigned int LIGHT_CELLS_SLOT = 4;
+    constexpr unsigned int LIGHT_INDEXES_SLOT = 5;
+
+    // std140 mirror of the Camera block
+    struct CameraBlock {
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::vec4 camPos;
+        glm::vec4 clusterParams; // near, far, slice scale
+    };
+
+    // Single light as four RGBA32F texels of the light data buffer
+    // type is stored as a float value, its int bits would be denormals the GPU may flush to zero
+    struct LightBlock {
+        glm::vec4 color;
+        glm::vec3 function;
+        float type;
+        glm::vec3 pos;
+        float penumbra;
+        glm::vec3 dir;
+        float angle;
+    };
+
+    // std140 mirror of the Globals block
+    struct GlobalBlock {
+        float ka, kd, ks;
+        int numDirLights; // directional lights lead the light data buffer
+    };
+
+    // std140 mirror of a single Material struct
+    struct MaterialBlock {
+        glm::vec4 ambient;
+        glm::vec4 diffuse;
+        glm::vec4 specular;
+        float shininess;
+        float blend;
+        float repeatU;
+        float repeatV;
+    };
+
+    static_assert(sizeof(CameraBlock) == 160, "Camera block must match std140 layout");
+    static_assert(sizeof(LightBlock) == 64, "Light must span four texels");
+    static_assert(sizeof(GlobalBlock) == 16, "Globals block must match std140 layout");
+    static_assert(sizeof(MaterialBlock) == 64, "Material struct must match std140 layout");
+
+    // Typed table of uniform locations, resolved once at link time, -1 if compiled out of the variant
+    struct UniformTable {
+        // texture vars
+        GLint tex, normTex;
+
+        // bone vars
+        GLint skinPalette;
+
+        // light vars
+        GLint lightData, lightCells, lightIndexes;
+    };
+
+    UniformTable loadUniformTable(GLuint shader, const std::unordered_map<std::string, GLint>& uniforms, uint32_t features);
+
+    void passGlobalBlock(const UniformBuffer& ubo, const SceneGlobalData& global, int numDirLights);
+
+    void passCamBlock(const UniformBuffer& ubo, const Camera& cam, const LightGrid& grid);
+
+    void passLightData(TextureBuffer& tbo, const std::vector<SceneLightData>& lights);
+
+    void passLightGrid(TextureBuffer& cells, TextureBuffer& indexes, const LightGrid& grid);
+
+    void passSamplerVars(const UniformTable& uni);
+
+    MaterialBlock getMaterialBlock(const SceneMaterial& material);
+
+    void passMaterialBlock(const UniformBuffer& ubo, const std::vector<MaterialBlock>& materials);
 }
 
 #endif // UNILOADER_H
@@ -0,0 +1,170 @@
+// CPU light binning checks, runs without a GL context
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <tuple>
+#include <glm/glm.hpp>
+#include "scene/lightgrid.h"
+
+namespace
+{
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (condition) return;
+
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+
+    SceneLightData makeLight(LightType type, float brightness, const glm::vec3& function) {
+        SceneLightData light{};
+        light.type = type;
+        light.color = SceneColor{brightness, brightness, brightness, 1.f};
+        light.function = function;
+        light.pos = glm::vec4{0.f, 0.f, 0.f, 1.f};
+        light.dir = glm::vec4{0.f, 0.f, -1.f, 0.f};
+        return light;
+    }
+
+    // attenuated brightness of light at distance d, as the shader computes it
+    float attenuate(const SceneLightData& light, float d) {
+        const glm::vec3& c = light.function;
+        return light.color.r / (c.x + c.y * d + c.z * d * d);
+    }
+
+    void testRange() {
+        // Quadratic falloff reaches exactly the cutoff at the range
+        SceneLightData quadratic = makeLight(LightType::LIGHT_POINT, 1.f, {1.f, 0.f, 1.f});
+        float range = LightGrid::getRange(quadratic);
+        check(std::abs(range - std::sqrt(255.f)) < 1e-3f, "quadratic range solves for the 1/256 cutoff");
+        check(std::abs(attenuate(quadratic, range) - LightGrid::MIN_ILLUMINANCE) < 1e-6f, "brightness at range is 1/256");
+
+        SceneLightData linear = makeLight(LightType::LIGHT_POINT, 1.f, {1.f, 1.f, 0.f});
+        check(std::abs(LightGrid::getRange(linear) - 255.f) < 1e-3f, "linear range solves for the 1/256 cutoff");
+
+        // Constant term alone already at or below the cutoff, light never shows
+        float brightness = 2.f;
+        float target = brightness / LightGrid::MIN_ILLUMINANCE;
+        check(LightGrid::getRange(makeLight(LightType::LIGHT_POINT, brightness, {target, 0.f, 1.f})) == 0.f,
+              "constant term equal to the cutoff drops the light");
+        check(LightGrid::getRange(makeLight(LightType::LIGHT_POINT, brightness, {target * 2.f, 1.f, 1.f})) == 0.f,
+              "constant term past the cutoff drops the light");
+        check(LightGrid::getRange(makeLight(LightType::LIGHT_POINT, brightness, {target * 2.f, 1.f, 0.f})) == 0.f,
+              "constant term past the cutoff drops a linear light");
+        check(LightGrid::getRange(makeLight(LightType::LIGHT_POINT, brightness, {target * 0.99f, 0.f, 1.f})) > 0.f,
+              "constant term just under the cutoff keeps the light");
+
+        check(LightGrid::getRange(makeLight(LightType::LIGHT_POINT, 0.f, {1.f, 0.f, 1.f})) == 0.f, "black light is dropped");
+        check(std::isinf(LightGrid::getRange(makeLight(LightType::LIGHT_POINT, 1.f, {1.f, 0.f, 0.f}))),
+              "unattenuated light has infinite range");
+    }
+
+    void testBoundingSphere() {
+        float range = 10.f;
+
+        // Narrow cone fits a sphere through the apex and the cap rim, smaller than the range
+        SceneLightData narrow = makeLight(LightType::LIGHT_SPOT, 1.f, {1.f, 0.f, 1.f});
+        narrow.angle = 0.3f;
+
+        glm::vec4 sphere = LightGrid::getBoundingSphere(narrow, range);
+        check(sphere.w < range, "narrow cone sphere is smaller than the range");
+        check(sphere.z < 0.f && sphere.x == 0.f && sphere.y == 0.f, "narrow cone sphere is centered along the cone axis");
+
+        // Every point of the cone within range must be inside
+        bool contained = true;
+        for (float t = 0.f; t <= 1.f; t += 0.125f) {
+            for (float a = 0.f; a <= narrow.angle; a += narrow.angle / 8.f) {
+                glm::vec3 point = t * range * glm::vec3{std::sin(a), 0.f, -std::cos(a)};
+                contained &= glm::length(point - glm::vec3{sphere}) <= sphere.w + 1e-4f;
+            }
+        }
+        check(contained, "narrow cone sphere contains the cone");
+
+        // Wide cone falls back to the sphere around the apex
+        SceneLightData wide = narrow;
+        wide.angle = 1.2f;
+
+        glm::vec4 fallback = LightGrid::getBoundingSphere(wide, range);
+        check(fallback == glm::vec4{0.f, 0.f, 0.f, range}, "wide cone falls back to a sphere around the apex");
+
+        SceneLightData point = makeLight(LightType::LIGHT_POINT, 1.f, {1.f, 0.f, 1.f});
+        check(LightGrid::getBoundingSphere(point, range) == glm::vec4{0.f, 0.f, 0.f, range}, "point light sphere is its range");
+    }
+
+    void testBinning() {
+        float near = 0.1f, far = 100.f;
+
+        LightGrid grid;
+        grid.setProjection(glm::radians(90.f), glm::radians(90.f), near, far);
+
+        // Directional light reaches every fragment without the grid
+        std::vector<SceneLightData> lights{makeLight(LightType::LIGHT_DIRECTIONAL, 1.f, {1.f, 0.f, 0.f})};
+
+        // Point light of range 0.5 straight ahead at depth 10, on the border of the two middle columns
+        SceneLightData point = makeLight(LightType::LIGHT_POINT, 1.25f / 256.f, {1.f, 0.f, 1.f});
+        point.pos = glm::vec4{0.f, 0.f, -10.f, 1.f};
+        lights.push_back(point);
+
+        check(std::abs(LightGrid::getRange(point) - 0.5f) < 1e-4f, "binned light has range 0.5");
+
+        grid.build(lights, glm::mat4{1.f});
+
+        // Slices whose depth range overlaps the sphere's, same exponential split as the grid
+        std::set<std::tuple<int, int, int>> expected;
+        for (int s = 0; s < LightGrid::SLICES; ++s) {
+            float zNear = near * std::pow(far / near, s * 1.f / LightGrid::SLICES);
+            float zFar = near * std::pow(far / near, (s + 1) * 1.f / LightGrid::SLICES);
+
+            if (zNear < 10.5f && zFar > 9.5f) {
+                for (int x : {LightGrid::TILES_X / 2 - 1, LightGrid::TILES_X / 2}) {
+                    expected.insert({s, LightGrid::TILES_Y / 2, x});
+                }
+            }
+        }
+
+        std::set<std::tuple<int, int, int>> found;
+        const std::vector<glm::uvec2>& cells = grid.getCells();
+        const std::vector<uint32_t>& indexes = grid.getIndexes();
+
+        bool onlyPoint = true;
+        for (int c = 0; c < LightGrid::NUM_CLUSTERS; ++c) {
+            for (uint32_t i = cells[c].x; i < cells[c].x + cells[c].y; ++i) {
+                onlyPoint &= indexes[i] == 1;
+
+                int x = c % LightGrid::TILES_X;
+                int y = c / LightGrid::TILES_X % LightGrid::TILES_Y;
+                int s = c / (LightGrid::TILES_X * LightGrid::TILES_Y);
+                found.insert({s, y, x});
+            }
+        }
+
+        check(onlyPoint, "directional light is never binned");
+        check(!expected.empty() && found == expected, "point light lands only in the clusters around it");
+    }
+
+    void testOrdering() {
+        std::vector<SceneLightData> lights;
+        for (LightType type : {LightType::LIGHT_POINT, LightType::LIGHT_DIRECTIONAL, LightType::LIGHT_SPOT, LightType::LIGHT_DIRECTIONAL}) {
+            lights.push_back(makeLight(type, 1.f, {1.f, 0.f, 0.f}));
+            lights.back().id = lights.size() - 1;
+        }
+
+        int numDirLights = LightGrid::orderLights(lights);
+
+        check(numDirLights == 2, "two directional lights counted");
+        check(lights[0].id == 1 && lights[1].id == 3, "directional lights first, in scene order");
+        check(lights[2].id == 0 && lights[3].id == 2, "other lights follow, in scene order");
+    }
+}
+
+int main() {
+    testRange();
+    testBoundingSphere();
+    testBinning();
+    testOrdering();
+
+    if (failures == 0) std::cout << "All light grid tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}